@@ -1,15 +1,32 @@
 #include "ofApp.h"
+#include "BinaryMesh.h"
 
 namespace {
 ofTexture texture_;
 ofMesh mesh_;
+binary_mesh::MappedMesh mapped_;
+ofVbo vbo_;
 }
 
 //--------------------------------------------------------------
 void ofApp::setup(){
 //	ofDisableArbTex();
 	ofLoadImage(texture_, "of.png");
-	mesh_.load("export_arb.ply");
+	if(mapped_.load("export_arb.bmsh")) {
+		// upload straight from the mapped file
+		int num = mapped_.getNumVertices();
+		vbo_.setVertexData(mapped_.getVertices(), num, GL_STATIC_DRAW);
+		if(mapped_.hasTexCoords()) {
+			vbo_.setTexCoordData(mapped_.getTexCoords(), num, GL_STATIC_DRAW);
+		}
+		if(mapped_.hasColors()) {
+			vbo_.setColorData(mapped_.getColors(), num, GL_STATIC_DRAW);
+		}
+		vbo_.setIndexData(reinterpret_cast<const ofIndexType*>(mapped_.getIndices()), mapped_.getNumIndices(), GL_STATIC_DRAW);
+	}
+	else {
+		mesh_.load("export_arb.ply");
+	}
 }
 
 //--------------------------------------------------------------
@@ -20,7 +37,12 @@ void ofApp::update(){
 //--------------------------------------------------------------
 void ofApp::draw(){
 	texture_.bind();
-	mesh_.draw();
+	if(mapped_.isLoaded()) {
+		vbo_.drawElements(ofGetGLPrimitiveMode(mapped_.getMode()), mapped_.getNumIndices());
+	}
+	else {
+		mesh_.draw();
+	}
 	texture_.unbind();
 }
 
@@ -5,17 +5,258 @@
 #include "ofxBlendScreen.h"
 #include "SaveData.h"
 #include "AppFunc.h"
+#include "JobPool.h"
+#include "MeshStreamWriter.h"
+#include "Profiler.h"
+#include <limits>
 
 #pragma mark - IO
 
 namespace {
 template<typename T>
-void writeTo(std::ostream& os, const T& t) {
-	os.write(reinterpret_cast<const char*>(&t), sizeof(T));
+void writeTo(ByteWriter &writer, const T &t) {
+	writer.write(t);
 }
 template<typename T>
-void readFrom(std::istream& is, T& t) {
-	is.read(reinterpret_cast<char*>(&t), sizeof(T));
+bool readFrom(ByteReader &reader, T &t) {
+	return reader.read(t);
+}
+// multiplies interleaved xy pairs. kept branch-free so that the compiler can vectorize it.
+void scalePoints(const float *src, float *dst, std::size_t num_points, const glm::vec2 &scale)
+{
+	for(std::size_t i = 0; i < num_points; ++i) {
+		dst[i*2+0] = src[i*2+0]*scale.x;
+		dst[i*2+1] = src[i*2+1]*scale.y;
+	}
+}
+
+// names are stored as u64 length and the characters padded to 4 bytes
+const int name_alignment = 4;
+void writeName(ByteWriter &writer, const std::string &name)
+{
+	const char padding[name_alignment] = {};
+	std::size_t pad_size = std::ceil(name.size()/(float)name_alignment) * name_alignment;
+	writer.writeLE<uint64_t>(name.size());
+	writer.write(name.data(), name.size());
+	writer.write(padding, pad_size-name.size());
+}
+bool readName(ByteReader &reader, std::string &name)
+{
+	uint64_t name_size;
+	if(!reader.readLE(name_size)) {
+		return false;
+	}
+	uint64_t pad_size = std::ceil(name_size/(float)name_alignment) * name_alignment;
+	if(pad_size > reader.remaining()) {
+		ofLogError("DataContainer") << "broken data: name is longer than the rest of the data";
+		return false;
+	}
+	name.assign(reader.current(), name_size);
+	return reader.skip(pad_size);
+}
+
+// since v2 a container starts with a table of contents so that each record can be found without decoding the others:
+//   u64 num | { u64 offset | u64 size | name } * num | records...
+// offsets are from the beginning of the container.
+struct TocEntry {
+	std::string name;
+	uint64_t offset=0, size=0;
+};
+// returns where the offset of each entry is, to be filled by patchToc
+std::vector<std::size_t> writeToc(ByteWriter &writer, const std::vector<std::string> &names)
+{
+	std::vector<std::size_t> ret;
+	ret.reserve(names.size());
+	writer.writeLE<uint64_t>(names.size());
+	for(auto &&name : names) {
+		ret.push_back(writer.tell());
+		writer.writeLE<uint64_t>(0);	// placeholder for offset
+		writer.writeLE<uint64_t>(0);	// placeholder for size
+		writeName(writer, name);
+	}
+	return ret;
+}
+void patchToc(ByteWriter &writer, std::size_t entry_pos, uint64_t offset, uint64_t size)
+{
+	writer.writeAtLE(entry_pos, offset);
+	writer.writeAtLE(entry_pos+sizeof(uint64_t), size);
+}
+bool readToc(ByteReader &reader, std::vector<TocEntry> &toc)
+{
+	auto container_begin = reader.tell();
+	uint64_t num;
+	if(!reader.readLE(num)) {
+		return false;
+	}
+	toc.clear();
+	while(num-->0) {
+		TocEntry entry;
+		if(!reader.readLE(entry.offset) || !reader.readLE(entry.size) || !readName(reader, entry.name)) {
+			return false;
+		}
+		auto available = reader.size()-container_begin;
+		if(entry.offset > available || entry.size > available-entry.offset) {
+			ofLogError("DataContainer") << "broken data: record out of range: " << entry.name;
+			return false;
+		}
+		toc.push_back(entry);
+	}
+	return true;
+}
+template<typename Data>
+std::shared_ptr<Data> unpackRecord(const ByteReader &reader, std::size_t container_begin, const TocEntry &entry, const glm::vec2 &scale)
+{
+	ByteReader record(reader.data()+container_begin+entry.offset, entry.size);
+	record.setVersion(reader.getVersion());
+	auto data = std::make_shared<Data>();
+	data->unpack(record, scale);
+	return data;
+}
+}
+
+#pragma mark - Tessellation
+
+namespace {
+template<typename T>
+float getTwist(const T p[4]) { return glm::length(p[3]-p[2]-p[1]+p[0]); }
+template<typename T>
+float getEdgeLength(const T p[4]) { return glm::length(p[1]-p[0]) + glm::length(p[2]-p[0]) + glm::length(p[3]-p[1]) + glm::length(p[3]-p[2]); }
+// the twist (p11-p10-p01+p00) is the only non-linear term of a bilinear cell.
+// splitting the cell n times both ways leaves at most |twist|/(4n^2) between the surface and the triangles.
+int getAdaptiveDivision(const glm::vec3 v[4], const glm::vec2 t[4], float resample_min_interval, float tolerance)
+{
+	float error = getTwist(v);
+	// texture coordinates that are not a parallelogram shift the image as much, measured in the same pixels
+	float t_length = getEdgeLength(t);
+	if(t_length > 0) {
+		error = std::max(error, getTwist(t)*getEdgeLength(v)/t_length);
+	}
+	int n = std::ceil(std::sqrt(error/(4*tolerance)));
+	// never finer than the uniform subdivision by resample_min_interval
+	if(resample_min_interval > 0) {
+		float longest = std::max({glm::length(v[1]-v[0]), glm::length(v[2]-v[0]), glm::length(v[3]-v[1]), glm::length(v[3]-v[2])});
+		n = std::min<int>(n, std::ceil(longest/resample_min_interval));
+	}
+	return std::max(n, 1);
+}
+template<typename T>
+T bilinear(const T p[4], float s, float u) { return p[0]*((1-s)*(1-u)) + p[1]*(s*(1-u)) + p[2]*((1-s)*u) + p[3]*(s*u); }
+// corners are in the order of (0,0),(1,0),(0,1),(1,1)
+ofMesh tessellateBilinear(const glm::vec3 v[4], const glm::vec2 t[4], const ofFloatColor c[4], int n)
+{
+	ofMesh ret;
+	ret.setMode(OF_PRIMITIVE_TRIANGLES);
+	auto &&vertices = ret.getVertices();
+	auto &&texcoords = ret.getTexCoords();
+	auto &&colors = ret.getColors();
+	auto &&indices = ret.getIndices();
+	vertices.reserve((n+1)*(n+1));
+	texcoords.reserve((n+1)*(n+1));
+	colors.reserve((n+1)*(n+1));
+	indices.reserve(n*n*6);
+	for(int y = 0; y <= n; ++y) {
+		for(int x = 0; x <= n; ++x) {
+			float s = x/(float)n, u = y/(float)n;
+			vertices.push_back(bilinear(v, s, u));
+			texcoords.push_back(bilinear(t, s, u));
+			colors.push_back(bilinear(c, s, u));
+		}
+	}
+	for(int y = 0; y < n; ++y) {
+		for(int x = 0; x < n; ++x) {
+			ofIndexType lt = y*(n+1)+x, rt = lt+1, lb = lt+n+1, rb = lb+1;
+			indices.insert(end(indices), {lt, rt, lb, rt, rb, lb});
+		}
+	}
+	return ret;
+}
+bool isSameQuad(const geom::Quad &a, const geom::Quad &b)
+{
+	return std::equal(a.begin(), a.end(), b.begin());
+}
+// offsets are precomputed so that each mesh can be copied into its own range concurrently
+void concatenate(const std::vector<const ofMesh*> &src, ofMesh &dst)
+{
+	PROFILE_SCOPE("concatenate");
+	std::vector<std::size_t> vertex_offset(src.size()+1, 0), index_offset(src.size()+1, 0);
+	bool has_texcoords = true, has_colors = true;
+	for(std::size_t i = 0; i < src.size(); ++i) {
+		auto &&m = *src[i];
+		vertex_offset[i+1] = vertex_offset[i] + m.getNumVertices();
+		index_offset[i+1] = index_offset[i] + m.getNumIndices();
+		has_texcoords &= m.getNumTexCoords() == m.getNumVertices();
+		has_colors &= m.getNumColors() == m.getNumVertices();
+	}
+	dst.clear();
+	dst.setMode(OF_PRIMITIVE_TRIANGLES);
+	dst.getVertices().resize(vertex_offset.back());
+	dst.getIndices().resize(index_offset.back());
+	if(has_texcoords) dst.getTexCoords().resize(vertex_offset.back());
+	if(has_colors) dst.getColors().resize(vertex_offset.back());
+	auto *v = dst.getVerticesPointer();
+	auto *t = dst.getTexCoordsPointer();
+	auto *c = dst.getColorsPointer();
+	auto *idx = dst.getIndexPointer();
+	JobPool::shared().parallelFor(src.size(), [&](std::size_t i) {
+		auto &&m = *src[i];
+		auto offset = vertex_offset[i];
+		std::copy(begin(m.getVertices()), end(m.getVertices()), v+offset);
+		if(has_texcoords) std::copy(begin(m.getTexCoords()), end(m.getTexCoords()), t+offset);
+		if(has_colors) std::copy(begin(m.getColors()), end(m.getColors()), c+offset);
+		std::transform(begin(m.getIndices()), end(m.getIndices()), idx+index_offset[i], [offset](ofIndexType index) {
+			return static_cast<ofIndexType>(index + offset);
+		});
+	});
+}
+template<typename DataMap>
+void createMeshParallel(const DataMap &meshes, float resample_min_interval, const glm::vec2 &coord_size, float tolerance, ofMesh &dst)
+{
+	std::vector<ofMesh> result(meshes.size());
+	JobPool::shared().parallelFor(meshes.size(), [&](std::size_t i) {
+		result[i] = meshes[i].second->createMesh(resample_min_interval, coord_size, nullptr, tolerance);
+	});
+	std::vector<const ofMesh*> ptr;
+	ptr.reserve(result.size());
+	for(auto &&m : result) {
+		ptr.push_back(&m);
+	}
+	concatenate(ptr, dst);
+}
+// each MeshData is touched by only one job, so their caches can be updated concurrently
+template<typename DataMap>
+void getMeshParallel(const DataMap &meshes, float resample_min_interval, const glm::vec2 &coord_size, const ofRectangle *viewport, float tolerance, ofMesh &dst)
+{
+	std::vector<const ofMesh*> result(meshes.size());
+	JobPool::shared().parallelFor(meshes.size(), [&](std::size_t i) {
+		result[i] = &meshes[i].second->getMesh(resample_min_interval, coord_size, viewport, tolerance);
+	});
+	concatenate(result, dst);
+}
+// tessellates only as many meshes at once as the pool has threads and writes each of them out right away,
+// so that the whole mesh is never held in memory.
+template<typename DataMap>
+bool exportMeshStreaming(const std::filesystem::path &filepath, const DataMap &meshes, float resample_min_interval, const glm::vec2 &coord_size, float tolerance)
+{
+	MeshStreamWriter writer;
+	if(!writer.open(filepath)) {
+		return false;
+	}
+	auto &pool = JobPool::shared();
+	std::size_t batch_size = pool.getNumThreads();
+	for(std::size_t offset = 0; offset < meshes.size(); offset += batch_size) {
+		std::vector<ofMesh> result(std::min(batch_size, meshes.size()-offset));
+		pool.parallelFor(result.size(), [&](std::size_t i) {
+			result[i] = meshes[offset+i].second->createMesh(resample_min_interval, coord_size, nullptr, tolerance);
+		});
+		for(auto &&m : result) {
+			writer.append(m);
+		}
+	}
+	if(!writer.close()) {
+		ofLogError("MeshData") << "failed to export mesh: " << filepath;
+		return false;
+	}
+	return true;
 }
 }
 
@@ -28,9 +269,25 @@ void DataContainerBase::save(const std::filesystem::path &filepath, glm::vec2 sc
 void DataContainerBase::load(const std::filesystem::path &filepath, glm::vec2 scale)
 {
 	clear();
-	ofFile file(filepath);
-	unpack(file, scale);
-	file.close();
+	SaveData::withFileReader(filepath, [this, &scale](ByteReader &reader) {
+		unpack(reader, scale);
+	});
+}
+void DataContainerBase::pack(std::ostream &stream, const glm::vec2 &scale) const
+{
+	ByteWriter writer;
+	pack(writer, scale);
+	stream.write(writer.data(), writer.size());
+}
+void DataContainerBase::unpack(std::istream &stream, const glm::vec2 &scale)
+{
+	auto begin_pos = stream.tellg();
+	auto buffer = readRemaining(stream);
+	ByteReader reader(buffer.data(), buffer.size());
+	unpack(reader, scale);
+	// leave the stream right after what has been consumed
+	stream.clear();
+	stream.seekg(begin_pos + std::streamoff(reader.tell()));
 }
 
 template<typename Data>
@@ -41,73 +298,139 @@ void DataContainer<Data>::update() {
 }
 template<typename Data>
 bool DataContainer<Data>::remove(const std::string &name) {
-	auto found = find(data_, name);
+	auto found = find(name);
 	if(found == std::end(data_)) {
 		return false;
 	}
 	data_.erase(found);
+	invalidateIndex();
+	setModified();
 	return true;
 }
 template<typename Data>
 bool DataContainer<Data>::remove(const std::shared_ptr<Data> data) {
-	auto found = std::find_if(begin(data_), end(data_), [data](const std::pair<std::string, std::shared_ptr<Data>> d) {
-		return d.second == data;
-	});
+	auto found = findByKey(data.get());
 	if(found == std::end(data_)) {
 		return false;
 	}
 	data_.erase(found);
+	invalidateIndex();
+	setModified();
 	return true;
 }
 
 template<typename Data>
-bool DataContainer<Data>::isVisible(std::shared_ptr<Data> data) const
+void DataContainer<Data>::updateIndex() const
 {
-	return std::any_of(begin(data_), end(data_), [](const std::pair<std::string, std::shared_ptr<Data>> d) {
-		return d.second->is_solo;
-	}) ? data->is_solo && !data->is_hidden : !data->is_hidden;
+	if(is_index_valid_) {
+		return;
+	}
+	index_.name.clear();
+	index_.key.clear();
+	for(std::size_t i = 0; i < data_.size(); ++i) {
+		addToIndex(i);
+	}
+	is_index_valid_ = true;
 }
 template<typename Data>
-bool DataContainer<Data>::isEditable(std::shared_ptr<Data> data, bool include_hidden) const
+void DataContainer<Data>::addToIndex(std::size_t slot) const
 {
-	return !data->is_locked && (include_hidden || isVisible(data));
+	auto &&d = data_[slot];
+	index_.name[d.first] = slot;
+	forEachIndexKey(*d.second, [&](const void *key) {
+		index_.key[key] = slot;
+	});
 }
-
 template<typename Data>
-typename DataContainer<Data>::DataMap DataContainer<Data>::getVisibleData() const
+std::pair<typename DataContainer<Data>::DataMap::iterator, bool> DataContainer<Data>::insert(NamedData data)
 {
-	DataMap ret;
-	auto isVisible = std::any_of(begin(data_), end(data_), [](const std::pair<std::string, std::shared_ptr<Data>> d) {
-		return d.second->is_solo;
-	}) ? std::function<bool(std::shared_ptr<Data>)>([](std::shared_ptr<Data> d) {
-		return d->is_solo && !d->is_hidden;
-	}) : std::function<bool(std::shared_ptr<Data>)>([](std::shared_ptr<Data> d) {
-		return !d->is_hidden;
-	});
-	for(auto &&d : data_) {
-		if(isVisible(d.second)) {
-			ret.push_back(d);
-		}
+	auto found = find(data.first);
+	if(found != end(data_)) {
+		return {found, false};
+	}
+	data_.push_back(data);
+	addToIndex(data_.size()-1);
+	return {std::prev(end(data_)), true};
+}
+template<typename Data>
+typename DataContainer<Data>::DataMap::iterator DataContainer<Data>::find(const std::string &name)
+{
+	updateIndex();
+	auto found = index_.name.find(name);
+	return found == end(index_.name) ? end(data_) : begin(data_)+found->second;
+}
+template<typename Data>
+typename DataContainer<Data>::DataMap::iterator DataContainer<Data>::findByKey(const void *key)
+{
+	updateIndex();
+	auto found = index_.key.find(key);
+	return found == end(index_.key) ? end(data_) : begin(data_)+found->second;
+}
+template<typename Data>
+std::string DataContainer<Data>::getUniqueName(const std::string &name)
+{
+	if(find(name) == end(data_)) {
+		return name;
 	}
+	int &suffix = next_suffix_[name];
+	std::string ret;
+	do {
+		ret = name+ofToString(suffix++);
+	} while(find(ret) != end(data_));
 	return ret;
 }
+
 template<typename Data>
-typename DataContainer<Data>::DataMap DataContainer<Data>::getEditableData(bool include_hidden) const
+const typename DataContainer<Data>::Views& DataContainer<Data>::getViews() const
 {
-	DataMap ret;
-	auto isVisible = std::any_of(begin(data_), end(data_), [](const std::pair<std::string, std::shared_ptr<Data>> d) {
+	auto &&v = views_;
+	if(v.is_valid && v.generation == generation_) {
+		return v;
+	}
+	v.is_any_solo = std::any_of(begin(data_), end(data_), [](const NamedData &d) {
 		return d.second->is_solo;
-	}) ? std::function<bool(std::shared_ptr<Data>)>([](std::shared_ptr<Data> d) {
-		return d->is_solo && !d->is_hidden;
-	}) : std::function<bool(std::shared_ptr<Data>)>([](std::shared_ptr<Data> d) {
-		return !d->is_hidden;
 	});
+	v.visible.clear();
+	v.editable.clear();
+	v.editable_including_hidden.clear();
 	for(auto &&d : data_) {
-		if(!d.second->is_locked && (include_hidden || isVisible(d.second))) {
-			ret.push_back(d);
+		bool visible = v.is_any_solo ? d.second->is_solo && !d.second->is_hidden : !d.second->is_hidden;
+		if(visible) {
+			v.visible.push_back(d);
+		}
+		if(!d.second->is_locked) {
+			v.editable_including_hidden.push_back(d);
+			if(visible) {
+				v.editable.push_back(d);
+			}
 		}
 	}
-	return ret;
+	v.generation = generation_;
+	v.is_valid = true;
+	return v;
+}
+
+template<typename Data>
+bool DataContainer<Data>::isVisible(std::shared_ptr<Data> data) const
+{
+	return getViews().is_any_solo ? data->is_solo && !data->is_hidden : !data->is_hidden;
+}
+template<typename Data>
+bool DataContainer<Data>::isEditable(std::shared_ptr<Data> data, bool include_hidden) const
+{
+	return !data->is_locked && (include_hidden || isVisible(data));
+}
+
+template<typename Data>
+const typename DataContainer<Data>::DataMap& DataContainer<Data>::getVisibleData() const
+{
+	return getViews().visible;
+}
+template<typename Data>
+const typename DataContainer<Data>::DataMap& DataContainer<Data>::getEditableData(bool include_hidden) const
+{
+	auto &&v = getViews();
+	return include_hidden ? v.editable_including_hidden : v.editable;
 }
 
 template<typename Data>
@@ -162,7 +485,9 @@ void DataContainer<Data>::gui(std::function<bool(DataType&)> is_selected, std::f
 		auto &&m = meshes[i];
 		PushID(m.first.c_str());
 		bool editable = false;
-		switches(m.second, m.second->is_hidden, m.second->is_locked, m.second->is_solo, &editable);
+		if(switches(m.second, m.second->is_hidden, m.second->is_locked, m.second->is_solo, &editable)) {
+			setModified();
+		}
 		if(!editable) {
 			set_selected(*m.second, false);
 		}
@@ -224,10 +549,13 @@ void DataContainer<Data>::gui(std::function<bool(DataType&)> is_selected, std::f
 		}
 	}
 	if(update_mesh_name) {
-		auto found = find(meshes, mesh_edit_.first);
+		auto found = find(mesh_edit_.first);
 		assert(found != end(meshes));
-		if(mesh_name_buf_ != "" && insert(meshes, {mesh_name_buf_, found->second}).second) {
-			meshes.erase(found);
+		auto slot = std::distance(begin(meshes), found);
+		if(mesh_name_buf_ != "" && insert({mesh_name_buf_, found->second}).second) {
+			meshes.erase(begin(meshes)+slot);
+			invalidateIndex();
+			setModified();
 		}
 		mesh_edit_.second.reset();
 	}
@@ -247,6 +575,8 @@ void DataContainer<Data>::gui(std::function<bool(DataType&)> is_selected, std::f
 	}
 	if (move_from != -1 && move_to != -1) {
 		swap(meshes[move_to], meshes[move_from]);
+		invalidateIndex();
+		setModified();
 		ImGui::SetDragDropPayload(dnd_id, &move_to, sizeof(int));
 	}
 	if(!selected_meshes.empty()) {
@@ -262,39 +592,87 @@ void DataContainer<Data>::gui(std::function<bool(DataType&)> is_selected, std::f
 #pragma mark - IO
 
 template<typename Data>
-void DataContainer<Data>::pack(std::ostream &stream, const glm::vec2 &scale) const
+void DataContainer<Data>::pack(ByteWriter &writer, const glm::vec2 &scale) const
 {
-	writeTo(stream, data_.size());
-	const int name_alignemt = 4;
+	std::vector<std::string> names;
+	names.reserve(data_.size());
 	for(auto &&d : data_) {
-		auto name = d.first;
-		std::size_t name_size = name.size();
-		std::size_t pad_size = std::ceil(name_size/(float)name_alignemt) * name_alignemt;
-		writeTo(stream, name.size());
-		stream.write(name.c_str(), pad_size);
-		d.second->pack(stream, scale);
+		names.push_back(d.first);
+	}
+	auto container_begin = writer.tell();
+	auto entry_pos = writeToc(writer, names);
+	for(std::size_t i = 0; i < data_.size(); ++i) {
+		auto record_begin = writer.tell();
+		data_[i].second->pack(writer, scale);
+		patchToc(writer, entry_pos[i], record_begin-container_begin, writer.tell()-record_begin);
 	}
 }
 
 template<typename Data>
-void DataContainer<Data>::unpack(std::istream &stream, const glm::vec2 &scale)
+void DataContainer<Data>::unpack(ByteReader &reader, const glm::vec2 &scale)
 {
-	const int name_alignemt = 4;
 	data_.clear();
-	std::size_t num;
-	readFrom(stream, num);
-	while(num-->0) {
-		std::size_t name_size;
-		readFrom(stream, name_size);
-		std::size_t pad_size = std::ceil(name_size/(float)name_alignemt) * name_alignemt;
-		std::string name;
-		name.resize(pad_size);
-		stream.read(const_cast<char*>(name.data()), pad_size);
-		name.resize(name_size);
-		auto data = std::make_shared<Data>();
-		data->unpack(stream, scale);
-		insert(data_, {name, data});
+	invalidateIndex();
+	if(reader.getVersion() < 2) {
+		// v1 records have no size, so they can only be decoded in order
+		uint64_t num;
+		readFrom(reader, num);
+		while(num-->0 && reader.good()) {
+			std::string name;
+			if(!readName(reader, name)) {
+				break;
+			}
+			auto data = std::make_shared<Data>();
+			data->unpack(reader, scale);
+			insert({name, data});
+		}
+	}
+	else {
+		auto container_begin = reader.tell();
+		std::vector<TocEntry> toc;
+		if(readToc(reader, toc)) {
+			// records are independent, so they are decoded concurrently
+			std::vector<std::shared_ptr<Data>> decoded(toc.size());
+			JobPool::shared().parallelFor(toc.size(), [&](std::size_t i) {
+				decoded[i] = unpackRecord<Data>(reader, container_begin, toc[i], scale);
+			});
+			std::size_t container_end = reader.tell();
+			for(std::size_t i = 0; i < toc.size(); ++i) {
+				insert({toc[i].name, decoded[i]});
+				container_end = std::max<std::size_t>(container_end, container_begin+toc[i].offset+toc[i].size);
+			}
+			reader.seek(container_end);
+		}
+	}
+	setModified();
+}
+
+template<typename Data>
+std::shared_ptr<Data> DataContainer<Data>::unpackOne(ByteReader &reader, const std::string &name, const glm::vec2 &scale) const
+{
+	if(reader.getVersion() < 2) {
+		uint64_t num;
+		readFrom(reader, num);
+		while(num-->0 && reader.good()) {
+			std::string n;
+			if(!readName(reader, n)) {
+				break;
+			}
+			auto data = std::make_shared<Data>();
+			data->unpack(reader, scale);
+			if(n == name) {
+				return data;
+			}
+		}
+		return nullptr;
+	}
+	auto container_begin = reader.tell();
+	std::vector<TocEntry> toc;
+	if(!readToc(reader, toc)) {
+		return nullptr;
 	}
+	auto found = std::find_if(begin(toc), end(toc), [&name](const TocEntry &entry) { return entry.name == name; });
+	return found == end(toc) ? nullptr : unpackRecord<Data>(reader, container_begin, *found, scale);
 }
 
 template<typename Data>
@@ -302,11 +680,9 @@ std::pair<std::string, std::shared_ptr<Data>> DataContainer<Data>::createCopy(co
 {
 	auto d = std::make_shared<Data>();
 	*d = *src;
-	auto n = name;
-	int index = 0;
-	while(!insert(data_, {n, d}).second) {
-		n = name+ofToString(index++);
-	}
+	auto n = getUniqueName(name);
+	insert({n, d});
+	setModified();
 	return std::make_pair(n, d);
 }
 
@@ -320,9 +696,27 @@ bool DataContainer<Data>::isDirtyAny() const
 
 // -------------
 
-ofMesh WarpingMesh::createMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *use_area) const
+ofMesh WarpingMesh::createMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *use_area, float tolerance) const
 {
-	ofMesh ret = ofx::mapper::UpSampler().proc(*mesh, resample_min_interval, use_area);
+	// built from the same per-cell sampling as getMesh, so that export matches what the editor shows
+	std::vector<ofMesh> cells;
+	cells.reserve(mesh->getNumCols()*mesh->getNumRows());
+	for(int r = 0; r < mesh->getNumRows(); ++r) {
+		for(int c = 0; c < mesh->getNumCols(); ++c) {
+			ofRectangle bounds;
+			auto corner = getCellCorners(c, r, bounds);
+			if(!use_area || use_area->intersects(bounds)) {
+				cells.push_back(createCellMesh(corner, resample_min_interval, tolerance));
+			}
+		}
+	}
+	std::vector<const ofMesh*> ptr;
+	ptr.reserve(cells.size());
+	for(auto &&m : cells) {
+		ptr.push_back(&m);
+	}
+	ofMesh ret;
+	concatenate(ptr, ret);
 	auto uv = geom::getScaled(*uv_quad, remap_coord);
 	for(auto &t : ret.getTexCoords()) {
 		t = geom::rescalePosition(uv, t);
@@ -330,14 +724,240 @@ ofMesh WarpingMesh::createMesh(float resample_min_interval, const glm::vec2 &rem
 	return ret;
 }
 
+std::array<WarpingMesh::CellCache::Corner, 4> WarpingMesh::getCellCorners(int col, int row, ofRectangle &bounds) const
+{
+	std::array<CellCache::Corner, 4> ret;
+	for(int i = 0; i < ret.size(); ++i) {
+		auto p = mesh->getPoint(col+i%2, row+i/2);
+		ret[i] = {*p.v, *p.t, *p.c};
+		i == 0 ? bounds.set(glm::vec2(*p.v), 0, 0) : bounds.growToInclude(glm::vec2(*p.v));
+	}
+	return ret;
+}
+
+ofMesh WarpingMesh::createCellMesh(const std::array<CellCache::Corner, 4> &corner, float resample_min_interval, float tolerance) const
+{
+	if(tolerance > 0) {
+		glm::vec3 v[4];
+		glm::vec2 t[4];
+		ofFloatColor c[4];
+		for(int i = 0; i < corner.size(); ++i) {
+			v[i] = corner[i].v;
+			t[i] = corner[i].t;
+			c[i] = corner[i].c;
+		}
+		return tessellateBilinear(v, t, c, getAdaptiveDivision(v, t, resample_min_interval, tolerance));
+	}
+	ofx::mapper::Mesh cell;
+	cell.init({1,1}, {0,0,1,1}, {0,0,1,1});
+	for(int i = 0; i < corner.size(); ++i) {
+		auto p = cell.getPoint(i%2, i/2);
+		*p.v = corner[i].v;
+		*p.t = corner[i].t;
+		*p.c = corner[i].c;
+	}
+	return ofx::mapper::UpSampler().proc(cell, resample_min_interval);
+}
+
+WarpingMesh::CellCache& WarpingMesh::getCellCache(float resample_min_interval, float tolerance) const
+{
+	if(cell_cache_.size() > NUM_LOD_LEVELS && cell_cache_.count(resample_min_interval) == 0) {
+		cell_cache_.clear();
+	}
+	auto &cache = cell_cache_[resample_min_interval];
+	glm::ivec2 num_cells{mesh->getNumCols(), mesh->getNumRows()};
+	if(cache.num_cells != num_cells || cache.tolerance != tolerance) {
+		cache.num_cells = num_cells;
+		cache.tolerance = tolerance;
+		cache.cell.assign(num_cells.x*num_cells.y, {});
+		// the meshes built from the previous cells are rebuilt from scratch
+		cache.in_aggregate.clear();
+		cache.aggregate_generation = 0;
+		cache.in_tile.clear();
+	}
+	return cache;
+}
+
+void WarpingMesh::sampleCells(CellCache &cache, float resample_min_interval, const ofRectangle *use_area) const
+{
+	for(int r = 0; r < cache.num_cells.y; ++r) {
+		for(int c = 0; c < cache.num_cells.x; ++c) {
+			auto &cell = cache.cell[r*cache.num_cells.x+c];
+			auto corner = getCellCorners(c, r, cell.bounds);
+			if((cell.stamp != 0 && cell.corner == corner) || (use_area && !use_area->intersects(cell.bounds))) {
+				continue;
+			}
+			cell.corner = corner;
+			cell.mesh = createCellMesh(corner, resample_min_interval, cache.tolerance);
+			cell.stamp = ++cache.num_samplings;
+		}
+	}
+}
+
+void WarpingMesh::placeCells(const CellCache &cache, const std::vector<std::size_t> &cells, std::vector<CellCache::Placement> &placement, ofMesh &dst, const geom::Quad *uv)
+{
+	std::vector<const ofMesh*> src;
+	src.reserve(cells.size());
+	std::size_t vertex_offset = 0, index_offset = 0;
+	for(auto index : cells) {
+		auto &&m = cache.cell[index].mesh;
+		placement[index] = {cache.cell[index].stamp, vertex_offset, index_offset, m.getNumVertices(), m.getNumIndices()};
+		vertex_offset += m.getNumVertices();
+		index_offset += m.getNumIndices();
+		src.push_back(&m);
+	}
+	concatenate(src, dst);
+	if(uv) {
+		for(auto &t : dst.getTexCoords()) {
+			t = geom::rescalePosition(*uv, t);
+		}
+	}
+}
+
+bool WarpingMesh::patchCell(const CellCache::Cell &cell, CellCache::Placement &placement, ofMesh &dst, const geom::Quad *uv)
+{
+	auto &&src = cell.mesh;
+	if(src.getNumVertices() != placement.num_vertices || src.getNumIndices() != placement.num_indices) {
+		return false;
+	}
+	auto offset = placement.vertex_offset;
+	std::copy(begin(src.getVertices()), end(src.getVertices()), begin(dst.getVertices())+offset);
+	if(src.hasTexCoords() && dst.hasTexCoords()) {
+		std::transform(begin(src.getTexCoords()), end(src.getTexCoords()), begin(dst.getTexCoords())+offset, [uv](const glm::vec2 &t) {
+			return uv ? geom::rescalePosition(*uv, t) : t;
+		});
+	}
+	if(src.hasColors() && dst.hasColors()) {
+		std::copy(begin(src.getColors()), end(src.getColors()), begin(dst.getColors())+offset);
+	}
+	std::transform(begin(src.getIndices()), end(src.getIndices()), begin(dst.getIndices())+placement.index_offset, [offset](ofIndexType index) {
+		return static_cast<ofIndexType>(index + offset);
+	});
+	placement.stamp = cell.stamp;
+	return true;
+}
+
+const ofMesh& WarpingMesh::getMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *use_area, float tolerance) const
+{
+	is_dirty_ = false;
+	auto &cache = getCellCache(resample_min_interval, tolerance);
+	auto uv = geom::getScaled(*uv_quad, remap_coord);
+	bool is_same_area = use_area ? cache.aggregate_has_area && cache.aggregate_area == *use_area : !cache.aggregate_has_area;
+	if(cache.aggregate_generation == getGeneration() && is_same_area && isSameQuad(cache.aggregate_uv, uv)) {
+		return cache.aggregate;
+	}
+	PROFILE_SCOPE("MeshData::updateMesh");
+	sampleCells(cache, resample_min_interval, use_area);
+	auto &placement = cache.in_aggregate;
+	// texcoords in the aggregate are already remapped, so a new uv needs all cells placed again
+	bool need_rebuild = placement.size() != cache.cell.size() || !isSameQuad(cache.aggregate_uv, uv);
+	std::vector<std::size_t> in_use;
+	in_use.reserve(cache.cell.size());
+	for(std::size_t i = 0; i < cache.cell.size(); ++i) {
+		bool is_in_use = !use_area || use_area->intersects(cache.cell[i].bounds);
+		if(is_in_use) {
+			in_use.push_back(i);
+		}
+		// a cell added or removed shifts all the following cells
+		need_rebuild = need_rebuild || is_in_use != (placement[i].stamp != 0);
+	}
+	auto &aggregate = cache.aggregate;
+	if(!need_rebuild) {
+		// same cells as before; splice the re-sampled ones into the aggregate in place
+		for(auto index : in_use) {
+			auto &&cell = cache.cell[index];
+			if(placement[index].stamp != cell.stamp && !patchCell(cell, placement[index], aggregate, &uv)) {
+				need_rebuild = true;
+				break;
+			}
+		}
+	}
+	if(need_rebuild) {
+		placement.assign(cache.cell.size(), {});
+		placeCells(cache, in_use, placement, aggregate, &uv);
+	}
+	cache.aggregate_generation = getGeneration();
+	cache.aggregate_has_area = use_area != nullptr;
+	if(use_area) {
+		cache.aggregate_area = *use_area;
+	}
+	cache.aggregate_uv = uv;
+	return aggregate;
+}
+
+void WarpingMesh::updateLOD(LOD &lod, float resample_min_interval, const glm::vec2 &remap_coord, float tolerance) const
+{
+	auto &cache = getCellCache(resample_min_interval, tolerance);
+	sampleCells(cache, resample_min_interval, nullptr);
+	if(cache.cell.empty()) {
+		lod.tiles.clear();
+		return;
+	}
+	auto uv = geom::getScaled(*uv_quad, remap_coord);
+	auto updateBounds = [&](std::size_t tile) {
+		auto &bounds = lod.tiles[tile].first;
+		auto &&cells = cache.cells_of_tile[tile];
+		bounds = cache.cell[cells.front()].bounds;
+		for(auto index : cells) {
+			bounds.growToInclude(cache.cell[index].bounds);
+		}
+	};
+	auto rebuildTile = [&](std::size_t tile) {
+		placeCells(cache, cache.cells_of_tile[tile], cache.in_tile, lod.tiles[tile].second, &uv);
+		updateBounds(tile);
+	};
+	// texcoords in the tiles are already remapped, so editing uv_quad needs all tiles rebuilt even though no cell is re-sampled
+	if(!lod.is_valid || !isSameQuad(cache.tile_uv, uv) || cache.in_tile.size() != cache.cell.size()) {
+		cache.tile_uv = uv;
+		// rows and columns of cells are split as evenly as possible, at least one cell per tile
+		glm::ivec2 num_tiles = glm::min(cache.num_cells, glm::ivec2(LOD_TILES_PER_AXIS));
+		cache.tile_of_cell.resize(cache.cell.size());
+		cache.cells_of_tile.assign(num_tiles.x*num_tiles.y, {});
+		for(int r = 0; r < cache.num_cells.y; ++r) {
+			for(int c = 0; c < cache.num_cells.x; ++c) {
+				std::size_t index = r*cache.num_cells.x+c;
+				std::size_t tile = (r*num_tiles.y/cache.num_cells.y)*num_tiles.x + c*num_tiles.x/cache.num_cells.x;
+				cache.tile_of_cell[index] = tile;
+				cache.cells_of_tile[tile].push_back(index);
+			}
+		}
+		cache.in_tile.assign(cache.cell.size(), {});
+		lod.tiles.assign(cache.cells_of_tile.size(), {});
+		for(std::size_t tile = 0; tile < lod.tiles.size(); ++tile) {
+			rebuildTile(tile);
+		}
+		return;
+	}
+	// re-sampled cells are copied over their previous range. only a tile whose cells changed in size is rebuilt.
+	std::vector<bool> is_moved(lod.tiles.size(), false), need_rebuild(lod.tiles.size(), false);
+	for(std::size_t i = 0; i < cache.cell.size(); ++i) {
+		auto &&cell = cache.cell[i];
+		auto &placement = cache.in_tile[i];
+		if(placement.stamp == cell.stamp) {
+			continue;
+		}
+		auto tile = cache.tile_of_cell[i];
+		is_moved[tile] = true;
+		if(!need_rebuild[tile] && !patchCell(cell, placement, lod.tiles[tile].second, &uv)) {
+			need_rebuild[tile] = true;
+		}
+	}
+	for(std::size_t tile = 0; tile < lod.tiles.size(); ++tile) {
+		if(need_rebuild[tile]) {
+			rebuildTile(tile);
+		}
+		else if(is_moved[tile]) {
+			updateBounds(tile);
+		}
+	}
+}
+
 std::pair<std::string, std::shared_ptr<WarpingData::DataType>> WarpingData::create(const std::string &name, const glm::ivec2 &num_cells, const ofRectangle &vert_rect, const ofRectangle &coord_rect) {
-	std::string n = name;
-	int index=0;
+	std::string n = getUniqueName(name);
 	auto d = std::make_shared<DataType>();
-	while(!insert(data_, {n, d}).second) {
-		n = name+ofToString(index++);
-	}
+	insert({n, d});
 	d->init(num_cells, vert_rect, coord_rect);
+	setModified();
 	return std::make_pair(n, d);
 }
 
@@ -345,14 +965,25 @@ void WarpingData::uvRescale(const glm::vec2 &scale)
 {
 	for(auto &&d : data_) {
 		*d.second->uv_quad = getScaled(*d.second->uv_quad, scale);
+		d.second->setDirty();
+	}
+}
+
+void WarpingData::setTessellationTolerance(float tolerance)
+{
+	tolerance = std::max(tolerance, 0.f);
+	if(tolerance == tessellation_tolerance_) {
+		return;
+	}
+	tessellation_tolerance_ = tolerance;
+	for(auto &&d : data_) {
+		d.second->setDirty();
 	}
 }
 
 std::pair<std::string, std::shared_ptr<WarpingData::DataType>> WarpingData::find(std::shared_ptr<UVType> quad)
 {
-	auto found = std::find_if(begin(data_), end(data_), [quad](const std::pair<std::string, std::shared_ptr<DataType>> d) {
-		return d.second->uv_quad == quad;
-	});
+	auto found = findByKey(quad.get());
 	if(found == std::end(data_)) {
 		return {"", nullptr};
 	}
@@ -361,9 +992,7 @@ std::pair<std::string, std::shared_ptr<WarpingData::DataType>> WarpingData::find
 
 std::pair<std::string, std::shared_ptr<WarpingData::DataType>> WarpingData::find(std::shared_ptr<MeshType> mesh)
 {
-	auto found = std::find_if(begin(data_), end(data_), [mesh](const std::pair<std::string, std::shared_ptr<DataType>> d) {
-		return d.second->mesh == mesh;
-	});
+	auto found = findByKey(mesh.get());
 	if(found == std::end(data_)) {
 		return {"", nullptr};
 	}
@@ -373,85 +1002,103 @@ std::pair<std::string, std::shared_ptr<WarpingData::DataType>> WarpingData::find
 #pragma mark - IO
 
 
-void WarpingData::exportMesh(const std::filesystem::path &filepath, float resample_min_interval, const glm::vec2 &coord_size, bool only_visible) const
+bool WarpingData::exportMesh(const std::filesystem::path &filepath, float resample_min_interval, const glm::vec2 &coord_size, bool only_visible) const
 {
-	getMeshForExport(resample_min_interval, coord_size).save(filepath);
+	return exportMeshStreaming(filepath, only_visible ? getVisibleData() : data_, resample_min_interval, coord_size, tessellation_tolerance_);
 }
 
 ofMesh WarpingData::getMeshForExport(float resample_min_interval, const glm::vec2 &coord_size, bool only_visible) const
 {
 	ofMesh ret;
-	for(auto &&d : only_visible ? getVisibleData() : data_) {
-		ret.append(d.second->createMesh(resample_min_interval, coord_size));
-	}
+	createMeshParallel(only_visible ? getVisibleData() : data_, resample_min_interval, coord_size, tessellation_tolerance_, ret);
 	return ret;
 }
 
 ofMesh WarpingData::getMesh(float resample_min_interval, const glm::vec2 &coord_size, ofRectangle *viewport, bool only_visible) const
 {
 	ofMesh ret;
-	for(auto &&d : only_visible ? getVisibleData() : data_) {
-		ret.append(d.second->getMesh(resample_min_interval, coord_size, viewport));
-	}
+	getMeshParallel(only_visible ? getVisibleData() : data_, resample_min_interval, coord_size, viewport, tessellation_tolerance_, ret);
 	return ret;
 }
 
+const ofVboMesh& WarpingData::getRetainedMesh(float resample_min_interval, const glm::vec2 &coord_size, bool only_visible) const
+{
+	auto &&r = retained_;
+	auto &&meshes = only_visible ? getVisibleData() : data_;
+	std::vector<std::pair<const DataType*, std::size_t>> state;
+	state.reserve(meshes.size());
+	for(auto &&d : meshes) {
+		state.emplace_back(d.second.get(), d.second->getGeneration());
+	}
+	if(r.is_valid
+	   && r.state == state
+	   && ofIsFloatEqual(r.resample_min_interval, resample_min_interval)
+	   && r.coord_size == coord_size) {
+		return r.mesh;
+	}
+	r.mesh.setUsage(GL_DYNAMIC_DRAW);
+	getMeshParallel(meshes, resample_min_interval, coord_size, nullptr, tessellation_tolerance_, r.mesh);
+	r.state = std::move(state);
+	r.resample_min_interval = resample_min_interval;
+	r.coord_size = coord_size;
+	r.is_valid = true;
+	return r.mesh;
+}
+
 std::pair<std::string, std::shared_ptr<BlendingData::DataType>> BlendingData::create(const std::string &name, const ofRectangle &frame, const float &default_inner_ratio)
 {
-	std::string n = name;
-	int index=0;
+	std::string n = getUniqueName(name);
 	auto d = std::make_shared<DataType>();
-	while(!insert(data_, {n, d}).second) {
-		n = name+ofToString(index++);
-	}
+	insert({n, d});
 	d->init(frame, default_inner_ratio);
+	setModified();
 	return std::make_pair(n, d);
 }
 
 std::pair<std::string, std::shared_ptr<BlendingData::DataType>> BlendingData::find(std::shared_ptr<MeshType> mesh)
 {
-	auto found = std::find_if(begin(data_), end(data_), [mesh](const std::pair<std::string, std::shared_ptr<DataType>> d) {
-		return d.second->mesh == mesh;
-	});
+	auto found = findByKey(mesh.get());
 	if(found == std::end(data_)) {
 		return {"", nullptr};
 	}
 	return *found;
 }
 
-void BlendingData::exportMesh(const std::filesystem::path &filepath, float resample_min_interval, const glm::vec2 &coord_size, bool only_visible) const
+bool BlendingData::exportMesh(const std::filesystem::path &filepath, float resample_min_interval, const glm::vec2 &coord_size, bool only_visible) const
 {
-	getMeshForExport(resample_min_interval, coord_size).save(filepath);
+	return exportMeshStreaming(filepath, only_visible ? getVisibleData() : data_, resample_min_interval, coord_size, 0);
 }
 
 ofMesh BlendingData::getMeshForExport(float resample_min_interval, const glm::vec2 &coord_size, bool only_visible) const
 {
 	ofMesh ret;
-	for(auto &&d : only_visible ? getVisibleData() : data_) {
-		ret.append(d.second->createMesh(resample_min_interval, coord_size));
-	}
+	createMeshParallel(only_visible ? getVisibleData() : data_, resample_min_interval, coord_size, 0, ret);
 	return ret;
 }
 
 ofMesh BlendingData::getMesh(float resample_min_interval, const glm::vec2 &coord_size, ofRectangle *viewport, bool only_visible) const
 {
 	ofMesh ret;
-	for(auto &&d : only_visible ? getVisibleData() : data_) {
-		ret.append(d.second->getMesh(resample_min_interval, coord_size, viewport));
-	}
+	getMeshParallel(only_visible ? getVisibleData() : data_, resample_min_interval, coord_size, viewport, 0, ret);
 	return ret;
 }
 
-void BlendingData::pack(std::ostream &stream, const glm::vec2 &scale) const
+void BlendingData::pack(ByteWriter &writer, const glm::vec2 &scale) const
 {
-	SaveData::pack(stream, shader_->getParams());
-	DataContainer::pack(stream, scale);
+	SaveData::pack(writer, shader_->getParams());
+	DataContainer::pack(writer, scale);
 	
 }
-void BlendingData::unpack(std::istream &stream, const glm::vec2 &scale)
+void BlendingData::unpack(ByteReader &reader, const glm::vec2 &scale)
 {
-	SaveData::unpack(stream, shader_->getParams());
-	DataContainer::unpack(stream, scale);
+	SaveData::unpack(reader, shader_->getParams());
+	DataContainer::unpack(reader, scale);
+}
+std::shared_ptr<BlendingMesh> BlendingData::unpackOne(ByteReader &reader, const std::string &name, const glm::vec2 &scale) const
+{
+	ofxBlendScreen::Shader::Params params;
+	SaveData::unpack(reader, params);
+	return DataContainer::unpackOne(reader, name, scale);
 }
 
 void BlendingMesh::init(const ofRectangle &frame, float default_inner_ratio)
@@ -462,12 +1109,114 @@ void BlendingMesh::init(const ofRectangle &frame, float default_inner_ratio)
 	mesh->quad[1] = inner;
 }
 
-ofMesh MeshData::getMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *use_area) const
+namespace {
+// splits triangles into a grid over the bounds of the mesh by their centroids.
+// vertices shared across tiles are duplicated; bounds include every vertex of the tile's triangles.
+std::vector<std::pair<ofRectangle, ofMesh>> splitIntoTiles(const ofMesh &src, int tiles_per_axis)
+{
+	std::vector<std::pair<ofRectangle, ofMesh>> ret;
+	auto &&vertices = src.getVertices();
+	if(vertices.empty()) {
+		return ret;
+	}
+	glm::vec2 min(vertices.front()), max(vertices.front());
+	for(auto &&v : vertices) {
+		min = glm::min(min, glm::vec2(v));
+		max = glm::max(max, glm::vec2(v));
+	}
+	glm::vec2 tile_size = glm::max((max-min)/(float)tiles_per_axis, glm::vec2(std::numeric_limits<float>::epsilon()));
+	std::size_t num_indices = src.hasIndices() ? src.getNumIndices() : vertices.size();
+	auto getIndex = [&](std::size_t i) { return src.hasIndices() ? src.getIndex(i) : static_cast<ofIndexType>(i); };
+	std::vector<std::vector<std::size_t>> triangles(tiles_per_axis*tiles_per_axis);
+	for(std::size_t i = 0; i+2 < num_indices; i += 3) {
+		glm::vec2 center = (glm::vec2(vertices[getIndex(i)]) + glm::vec2(vertices[getIndex(i+1)]) + glm::vec2(vertices[getIndex(i+2)]))/3.f;
+		glm::ivec2 tile = glm::clamp(glm::ivec2((center-min)/tile_size), glm::ivec2(0), glm::ivec2(tiles_per_axis-1));
+		triangles[tile.y*tiles_per_axis+tile.x].push_back(i);
+	}
+	bool has_texcoords = src.getNumTexCoords() == vertices.size();
+	bool has_colors = src.getNumColors() == vertices.size();
+	// local index of each source vertex in the tile being built, valid while stamp matches
+	std::vector<ofIndexType> local(vertices.size());
+	std::vector<std::size_t> stamp(vertices.size(), triangles.size());
+	// source index of each vertex of the tile being built
+	std::vector<std::size_t> used;
+	for(std::size_t t = 0; t < triangles.size(); ++t) {
+		if(triangles[t].empty()) {
+			continue;
+		}
+		ofMesh mesh;
+		mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+		// indices first, so that the vertex buffers are allocated once
+		auto &&indices = mesh.getIndices();
+		indices.resize(triangles[t].size()*3);
+		auto dst_index = begin(indices);
+		used.clear();
+		for(auto &&first : triangles[t]) {
+			for(std::size_t j = first; j < first+3; ++j) {
+				auto index = getIndex(j);
+				if(stamp[index] != t) {
+					stamp[index] = t;
+					local[index] = used.size();
+					used.push_back(index);
+				}
+				*dst_index++ = local[index];
+			}
+		}
+		auto &&dst_vertices = mesh.getVertices();
+		dst_vertices.resize(used.size());
+		if(has_texcoords) mesh.getTexCoords().resize(used.size());
+		if(has_colors) mesh.getColors().resize(used.size());
+		ofRectangle bounds(glm::vec2(vertices[used.front()]), 0, 0);
+		for(std::size_t k = 0; k < used.size(); ++k) {
+			auto &&v = vertices[used[k]];
+			dst_vertices[k] = v;
+			if(has_texcoords) mesh.getTexCoords()[k] = src.getTexCoords()[used[k]];
+			if(has_colors) mesh.getColors()[k] = src.getColors()[used[k]];
+			bounds.growToInclude(glm::vec2(v));
+		}
+		ret.emplace_back(bounds, std::move(mesh));
+	}
+	return ret;
+}
+}
+
+int MeshData::getLODLevel(float resample_min_interval)
+{
+	float level = std::round(std::log2(std::max(resample_min_interval, LOD_BASE_INTERVAL)/LOD_BASE_INTERVAL));
+	return std::min<int>(level, NUM_LOD_LEVELS-1);
+}
+
+void MeshData::updateLOD(LOD &lod, float resample_min_interval, const glm::vec2 &remap_coord, float tolerance) const
+{
+	lod.tiles = splitIntoTiles(updateMesh(resample_min_interval, remap_coord, nullptr, tolerance), LOD_TILES_PER_AXIS);
+}
+
+void MeshData::withLODMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *viewport, std::function<void(const ofMesh&)> func, float tolerance) const
+{
+	int level = getLODLevel(resample_min_interval);
+	auto &lod = lod_[level];
+	if(!lod.is_valid || lod.generation != getGeneration() || lod.remap_coord != remap_coord || lod.tolerance != tolerance) {
+		PROFILE_SCOPE("MeshData::updateLOD");
+		updateLOD(lod, LOD_BASE_INTERVAL*(1<<level), remap_coord, tolerance);
+		lod.generation = getGeneration();
+		lod.remap_coord = remap_coord;
+		lod.tolerance = tolerance;
+		lod.is_valid = true;
+	}
+	for(auto &&tile : lod.tiles) {
+		if(tile.second.getNumIndices() > 0 && (!viewport || viewport->intersects(tile.first))) {
+			func(tile.second);
+		}
+	}
+}
+
+const ofMesh& MeshData::getMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *use_area, float tolerance) const
 {
 	auto create = [&]() {
-		return createMesh(resample_min_interval, remap_coord, use_area);
+		PROFILE_SCOPE("MeshData::updateMesh");
+		return updateMesh(resample_min_interval, remap_coord, use_area, tolerance);
 	};
-	CacheChecker checker{resample_min_interval, use_area};
+	CacheChecker checker{resample_min_interval, use_area, tolerance};
 	if(is_dirty_) {
 		memo_.updateIdentifier(checker);
 		memo_.reset(create());
@@ -480,7 +1229,7 @@ ofMesh MeshData::getMesh(float resample_min_interval, const glm::vec2 &remap_coo
 }
 
 
-ofMesh BlendingMesh::createMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *use_area) const
+ofMesh BlendingMesh::createMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *use_area, float tolerance) const
 {
 	auto outer_uv = getScaled(mesh->quad[0], remap_coord);
 	auto src_mesh = ofxBlendScreen::createMesh(mesh->quad[0], mesh->quad[1], outer_uv
@@ -536,68 +1285,71 @@ ofMesh BlendingMesh::getWireframe(const glm::vec2 &remap_coord, const ofFloatCol
 
 
 namespace geom {
-void pack(const Quad &quad, std::ostream &stream, glm::vec2 scale) {
-	for(int i = 0; i < quad.size(); ++i) {
-		writeTo(stream, quad.pt[i].x*scale.x);
-		writeTo(stream, quad.pt[i].y*scale.y);
-	}
+void pack(const Quad &quad, ByteWriter &writer, glm::vec2 scale) {
+	float buf[8];
+	scalePoints(&quad.pt[0].x, buf, quad.size(), scale);
+	writer.writeArrayLE(buf, 8);
 }
-void unpack(Quad &quad, std::istream &stream, glm::vec2 scale) {
-	for(int i = 0; i < quad.size(); ++i) {
-		readFrom(stream, quad.pt[i].x); quad.pt[i].x *= scale.x;
-		readFrom(stream, quad.pt[i].y); quad.pt[i].y *= scale.y;
+void unpack(Quad &quad, ByteReader &reader, glm::vec2 scale) {
+	float buf[8];
+	if(reader.readArrayLE(buf, 8)) {
+		scalePoints(buf, &quad.pt[0].x, quad.size(), scale);
 	}
 }
 
 }
-void MeshData::pack(std::ostream &stream, glm::vec2 scale) const
+void MeshData::pack(ByteWriter &writer, glm::vec2 scale) const
 {
-	writeTo(stream, is_hidden);
-	writeTo(stream, is_locked);
-	writeTo(stream, is_solo);
+	const bool flags[] = {is_hidden, is_locked, is_solo};
+	writer.writeArray(flags, 3);
 }
-void MeshData::unpack(std::istream &stream, glm::vec2 scale)
+void MeshData::unpack(ByteReader &reader, glm::vec2 scale)
 {
-	readFrom(stream, is_hidden);
-	readFrom(stream, is_locked);
-	readFrom(stream, is_solo);
+	bool flags[3];
+	if(reader.readArray(flags, 3)) {
+		is_hidden = flags[0];
+		is_locked = flags[1];
+		is_solo = flags[2];
+	}
 	setDirty();
 }
 
-void WarpingMesh::pack(std::ostream &stream, glm::vec2 scale) const
+// the mapper mesh has its own format and only speaks iostream, so it goes through the writer's stream
+void WarpingMesh::pack(ByteWriter &writer, glm::vec2 scale) const
 {
-	MeshData::pack(stream, scale);
-	geom::pack(*uv_quad, stream, scale);
-	mesh->pack(stream, interpolator.get());
+	MeshData::pack(writer, scale);
+	geom::pack(*uv_quad, writer, scale);
+	mesh->pack(writer.stream(), interpolator.get());
 }
-void WarpingMesh::unpack(std::istream &stream, glm::vec2 scale)
+void WarpingMesh::unpack(ByteReader &reader, glm::vec2 scale)
 {
-	MeshData::unpack(stream, scale);
-	geom::unpack(*uv_quad, stream, scale);
-	mesh->unpack(stream, interpolator.get());
+	MeshData::unpack(reader, scale);
+	geom::unpack(*uv_quad, reader, scale);
+	mesh->unpack(reader.stream(), interpolator.get());
 }
 
 
-void BlendingMesh::pack(std::ostream &stream, glm::vec2 scale) const
+void BlendingMesh::pack(ByteWriter &writer, glm::vec2 scale) const
 {
-	MeshData::pack(stream, scale);
-	writeTo(stream, blend_l);
-	writeTo(stream, blend_r);
-	writeTo(stream, blend_t);
-	writeTo(stream, blend_b);
+	MeshData::pack(writer, scale);
+	const bool flags[] = {blend_l, blend_r, blend_t, blend_b};
+	writer.writeArray(flags, 4);
 	for(int i = 0; i < MeshType::size(); ++i) {
-		geom::pack(mesh->quad[i], stream, scale);
+		geom::pack(mesh->quad[i], writer, scale);
 	}
 }
-void BlendingMesh::unpack(std::istream &stream, glm::vec2 scale)
+void BlendingMesh::unpack(ByteReader &reader, glm::vec2 scale)
 {
-	MeshData::unpack(stream, scale);
-	readFrom(stream, blend_l);
-	readFrom(stream, blend_r);
-	readFrom(stream, blend_t);
-	readFrom(stream, blend_b);
+	MeshData::unpack(reader, scale);
+	bool flags[4];
+	if(reader.readArray(flags, 4)) {
+		blend_l = flags[0];
+		blend_r = flags[1];
+		blend_t = flags[2];
+		blend_b = flags[3];
+	}
 	for(int i = 0; i < MeshType::size(); ++i) {
-		geom::unpack(mesh->quad[i], stream, scale);
+		geom::unpack(mesh->quad[i], reader, scale);
 	}
 }
 
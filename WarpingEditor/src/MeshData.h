@@ -8,29 +8,37 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
+#include <array>
+#include <atomic>
 #include "ofxMapperMesh.h"
 #include "ofxMapperUpSampler.h"
 #include "Quad.h"
 #include "ofxBlendScreen.h"
 #include "SaveData.h"
 #include "Memo.h"
+#include "ofVboMesh.h"
 
 class CacheChecker;
 struct CacheIdentifier {
 	float resample_min_interval;
+	float tolerance;
 	ofRectangle valid_viewport;
 	CacheIdentifier& operator=(const CacheChecker &c);
 };
 struct CacheChecker {
 	float resample_min_interval;
 	const ofRectangle *use_area;
+	float tolerance;
 	bool operator!=(const CacheIdentifier &cache) const {
 		return !ofIsFloatEqual(resample_min_interval, cache.resample_min_interval)
+		|| tolerance != cache.tolerance
 		|| (use_area && *use_area != cache.valid_viewport);
 	}
 };
 inline CacheIdentifier& CacheIdentifier::operator=(const CacheChecker &c) {
 	this->resample_min_interval = c.resample_min_interval;
+	this->tolerance = c.tolerance;
 	if(c.use_area) {
 		this->valid_viewport = *c.use_area;
 	}
@@ -40,16 +48,50 @@ struct MeshData {
 	bool is_hidden=false;
 	bool is_locked=false;
 	bool is_solo=false;
-	void setDirty() { is_dirty_ = true; }
+	void setDirty() { is_dirty_ = true; generation_ = newGeneration(); }
 	bool isDirty() const { return is_dirty_; }
-	void pack(std::ostream &stream, glm::vec2 scale) const;
-	void unpack(std::istream &stream, glm::vec2 scale);
-	ofMesh getMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr) const;
-	virtual ofMesh createMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr) const { return {}; }
+	// unique stamp updated on every setDirty. unlike isDirty, it is not cleared by getMesh.
+	std::size_t getGeneration() const { return generation_; }
+	// stamps are shared with the containers, so comparing the latest one tells if anything has been modified.
+	static std::size_t newGeneration() { return ++latestGeneration(); }
+	static std::size_t getLatestGeneration() { return latestGeneration(); }
+	void pack(ByteWriter &writer, glm::vec2 scale) const;
+	void unpack(ByteReader &reader, glm::vec2 scale);
+	// tolerance is the pixel-space error allowed between a curved surface and its triangles. 0 subdivides uniformly by resample_min_interval;
+	// otherwise resample_min_interval only limits how fine it gets. only WarpingMesh is curved, see WarpingData::setTessellationTolerance.
+	// the reference stays valid until the next getMesh call with different arguments or after setDirty
+	virtual const ofMesh& getMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr, float tolerance=0) const;
+	virtual ofMesh createMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr, float tolerance=0) const { return {}; }
+	// for editor views. the interval is snapped to the nearest level of LOD_BASE_INTERVAL*2^n and each level is cached apart from getMesh,
+	// so zooming back to a level or panning never re-tessellates.
+	// each level is split into tiles and func is called once per tile that intersects the viewport.
+	void withLODMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *viewport, std::function<void(const ofMesh&)> func, float tolerance=0) const;
+	static constexpr float LOD_BASE_INTERVAL = 100;
+	static const int NUM_LOD_LEVELS = 6;
+	static const int LOD_TILES_PER_AXIS = 8;
+	static int getLODLevel(float resample_min_interval);
 
 protected:
+	// called by getMesh when the cache is invalidated. may reuse the previous result partially.
+	virtual ofMesh updateMesh(float resample_min_interval, const glm::vec2 &remap_coord, const ofRectangle *use_area, float tolerance) const { return createMesh(resample_min_interval, remap_coord, use_area, tolerance); }
 	mutable Memo<ofMesh, CacheIdentifier, CacheChecker> memo_;
 	mutable bool is_dirty_=true;
+	struct LOD {
+		bool is_valid=false;
+		std::size_t generation;
+		glm::vec2 remap_coord;
+		float tolerance;
+		// bounds and triangles of each tile. tiles may be empty.
+		std::vector<std::pair<ofRectangle, ofMesh>> tiles;
+	};
+	// called by withLODMesh when the level is stale. lod still holds the previous tiles, and its is_valid, remap_coord and tolerance tell if they can be reused.
+	virtual void updateLOD(LOD &lod, float resample_min_interval, const glm::vec2 &remap_coord, float tolerance) const;
+private:
+	// built lazily; a level is stale when the generation has changed since
+	mutable std::array<LOD, NUM_LOD_LEVELS> lod_;
+	// atomic since meshes are created on worker threads while loading
+	static std::atomic<std::size_t>& latestGeneration() { static std::atomic<std::size_t> generation{0}; return generation; }
+	std::size_t generation_=newGeneration();
 };
 
 struct WarpingMesh : public MeshData {
@@ -58,7 +100,7 @@ struct WarpingMesh : public MeshData {
 	std::shared_ptr<UVType> uv_quad;
 	std::shared_ptr<MeshType> mesh;
 	std::shared_ptr<ofx::mapper::Interpolator> interpolator;
-	ofMesh createMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr) const override;
+	ofMesh createMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr, float tolerance=0) const override;
 	WarpingMesh() {
 		uv_quad = std::make_shared<UVType>();
 		mesh = std::make_shared<MeshType>();
@@ -70,6 +112,7 @@ struct WarpingMesh : public MeshData {
 		*mesh = *src.mesh;
 		*interpolator = *src.interpolator;
 		interpolator->setMesh(mesh);
+		setDirty();
 		return *this;
 	}
 	void init(const glm::ivec2 &num_cells, const ofRectangle &vert_rect, const ofRectangle &coord_rect={0,0,1,1}) {
@@ -78,9 +121,73 @@ struct WarpingMesh : public MeshData {
 	}
 	void update() {
 		interpolator->update();
+		// the interpolator moves points after the edit that marked this dirty,
+		// so stamp again for those who cache the point positions by generation.
+		if(interpolated_generation_ != getGeneration()) {
+			setDirty();
+			interpolated_generation_ = getGeneration();
+		}
 	}
-	void pack(std::ostream &stream, glm::vec2 scale) const;
-	void unpack(std::istream &stream, glm::vec2 scale);
+	void pack(ByteWriter &writer, glm::vec2 scale) const;
+	void unpack(ByteReader &reader, glm::vec2 scale);
+	// returns the aggregate of the cell cache, which is patched in place when only some cells are re-sampled.
+	// the reference stays valid until the next call with different arguments, or until a withLODMesh call evicts the cache.
+	const ofMesh& getMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr, float tolerance=0) const override;
+protected:
+	void updateLOD(LOD &lod, float resample_min_interval, const glm::vec2 &remap_coord, float tolerance) const override;
+private:
+	// tessellation result of each cell, kept to re-sample only the cells whose corners have changed
+	struct CellCache {
+		struct Corner {
+			glm::vec3 v;
+			glm::vec2 t;
+			ofFloatColor c;
+			bool operator==(const Corner &rhs) const { return v == rhs.v && t == rhs.t && c == rhs.c; }
+			bool operator!=(const Corner &rhs) const { return !(*this == rhs); }
+		};
+		struct Cell {
+			std::array<Corner, 4> corner;
+			ofRectangle bounds;
+			ofMesh mesh;
+			// changes on every sampling, 0 until sampled
+			std::size_t stamp=0;
+		};
+		// where a cell has been copied into a mesh built from the cells, and which sampling of it
+		struct Placement {
+			std::size_t stamp=0;
+			std::size_t vertex_offset=0, index_offset=0;
+			std::size_t num_vertices=0, num_indices=0;
+		};
+		glm::ivec2 num_cells={0,0};
+		float tolerance=0;
+		std::size_t num_samplings=0;
+		std::vector<Cell> cell;
+		// all cells in use with the texcoords remapped by aggregate_uv, for getMesh
+		ofMesh aggregate;
+		std::vector<Placement> in_aggregate;
+		geom::Quad aggregate_uv;
+		std::size_t aggregate_generation=0;
+		bool aggregate_has_area=false;
+		ofRectangle aggregate_area;
+		// cells grouped into the LOD tiles, for updateLOD. a cell stays in the same tile while num_cells is unchanged.
+		std::vector<std::size_t> tile_of_cell;
+		std::vector<std::vector<std::size_t>> cells_of_tile;
+		std::vector<Placement> in_tile;
+		// what the texcoords of the tiles are remapped by
+		geom::Quad tile_uv;
+	};
+	// one per interval, so that the LOD levels and the output don't evict each other
+	mutable std::map<float, CellCache> cell_cache_;
+	std::size_t interpolated_generation_=0;
+	std::array<CellCache::Corner, 4> getCellCorners(int col, int row, ofRectangle &bounds) const;
+	CellCache& getCellCache(float resample_min_interval, float tolerance) const;
+	// re-samples the cells that intersect use_area and whose corners have moved. bounds of every cell are updated.
+	void sampleCells(CellCache &cache, float resample_min_interval, const ofRectangle *use_area) const;
+	// rebuilds dst from the given cells and records where each of them is placed
+	static void placeCells(const CellCache &cache, const std::vector<std::size_t> &cells, std::vector<CellCache::Placement> &placement, ofMesh &dst, const geom::Quad *uv);
+	// copies the latest sampling of a cell over its placement. fails if the number of vertices or indices has changed.
+	static bool patchCell(const CellCache::Cell &cell, CellCache::Placement &placement, ofMesh &dst, const geom::Quad *uv);
+	ofMesh createCellMesh(const std::array<CellCache::Corner, 4> &corner, float resample_min_interval, float tolerance) const;
 };
 
 
@@ -94,11 +201,11 @@ struct BlendingMesh : public MeshData {
 	std::shared_ptr<MeshType> mesh;
 	void init(const ofRectangle &frame, float default_inner_ratio);
 	void update(){}
-	void pack(std::ostream &stream, glm::vec2 scale) const;
-	void unpack(std::istream &stream, glm::vec2 scale);
+	void pack(ByteWriter &writer, glm::vec2 scale) const;
+	void unpack(ByteReader &reader, glm::vec2 scale);
 
 	ofMesh getWireframe(const glm::vec2 &remap_coord={1,1}, const ofFloatColor &color=ofFloatColor::white) const;
-	ofMesh createMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr) const override;
+	ofMesh createMesh(float resample_min_interval, const glm::vec2 &remap_coord={1,1}, const ofRectangle *use_area=nullptr, float tolerance=0) const override;
 	bool blend_l=true;
 	bool blend_r=true;
 	bool blend_t=true;
@@ -125,6 +232,9 @@ public:
 	void load(const std::filesystem::path &filepath, glm::vec2 scale);
 	using HasSaveDataWithArg::pack;
 	using HasSaveDataWithArg::unpack;
+	// stream versions go through the buffer ones
+	void pack(std::ostream &stream, const glm::vec2 &scale) const override;
+	void unpack(std::istream &stream, const glm::vec2 &scale) override;
 	virtual void clear(){}
 	virtual void rescale(const glm::vec2 &scale) {}
 };
@@ -141,40 +251,65 @@ public:
 	void update();
 	bool remove(const std::string &name);
 	bool remove(const std::shared_ptr<DataType> mesh);
-	void clear() override { data_.clear(); }
+	void clear() override { data_.clear(); invalidateIndex(); setModified(); }
 	bool isDirtyAny() const;
+	// call when the list itself or anything not covered by MeshData::setDirty has changed
+	void setModified() { generation_ = MeshData::newGeneration(); }
+	std::size_t getGeneration() const { return generation_; }
 	DataMap& getData() { return data_; }
-	DataMap getVisibleData() const;
-	DataMap getEditableData(bool include_hidden=false) const;
+	// cached until the list or hidden/locked/solo changes (see setModified).
+	// the reference is valid until then, so don't modify the flags while iterating it.
+	const DataMap& getVisibleData() const;
+	const DataMap& getEditableData(bool include_hidden=false) const;
 	bool isVisible(std::shared_ptr<DataType> mesh) const;
 	bool isEditable(std::shared_ptr<DataType> mesh, bool include_hidden=false) const;
 
-	virtual void pack(std::ostream &stream, const glm::vec2 &scale) const override;
-	virtual void unpack(std::istream &stream, const glm::vec2 &scale) override;
+	using DataContainerBase::pack;
+	using DataContainerBase::unpack;
+	virtual void pack(ByteWriter &writer, const glm::vec2 &scale) const override;
+	virtual void unpack(ByteReader &reader, const glm::vec2 &scale) override;
+	// decodes only the named one from packed data of this container. nullptr if not found.
+	// v1 data has no table of contents, so the records before it are decoded and discarded.
+	virtual std::shared_ptr<Data> unpackOne(ByteReader &reader, const std::string &name, const glm::vec2 &scale) const;
 	
 	void gui(std::function<bool(DataType&)> is_selected, std::function<void(DataType&, bool)> set_selected, std::function<void()> create_new);
 protected:
 	DataMap data_;
-	std::pair<typename DataMap::iterator, bool> insert(DataMap &src, NamedData data) const {
-		auto found = find(src, data.first);
-		if(found != end(src)) {
-			return {found, false};
-		}
-		return {src.insert(end(src), data), true};
-	}
-	typename DataMap::iterator find(DataMap &src, const std::string &name) const {
-		for(auto it = begin(src); it != end(src); ++it) {
-			if(it->first == name) {
-				return it;
-			}
-		}
-		return end(src);
-	}
+	std::size_t generation_=MeshData::newGeneration();
+	// appends unless the name is already used
+	std::pair<typename DataMap::iterator, bool> insert(NamedData data);
+	typename DataMap::iterator find(const std::string &name);
+	// finds by any of the keys given by forEachIndexKey
+	typename DataMap::iterator findByKey(const void *key);
+	// the name itself if unused, otherwise the name with the smallest free numeric suffix tried so far
+	std::string getUniqueName(const std::string &name);
+	// keys other than the name to look up items in O(1). must not change while the item is in the container.
+	virtual void forEachIndexKey(const DataType &data, std::function<void(const void*)> func) const { func(&data); }
+	// call after erasing or reordering data_ directly
+	void invalidateIndex() { is_index_valid_ = false; }
 	NamedData createCopy(const std::string &name, std::shared_ptr<DataType> src);
 
 	NamedDataWeak mesh_edit_;
 	std::string mesh_name_buf_;
 	bool need_keyboard_focus_=false;
+private:
+	struct Index {
+		std::unordered_map<std::string, std::size_t> name;
+		std::unordered_map<const void*, std::size_t> key;
+	};
+	mutable Index index_;
+	mutable bool is_index_valid_=true;
+	struct Views {
+		bool is_valid=false;
+		std::size_t generation;
+		bool is_any_solo;
+		DataMap visible, editable, editable_including_hidden;
+	};
+	mutable Views views_;
+	const Views& getViews() const;
+	std::unordered_map<std::string, int> next_suffix_;
+	void updateIndex() const;
+	void addToIndex(std::size_t slot) const;
 };
 
 class WarpingData : public DataContainer<WarpingMesh>
@@ -189,10 +324,30 @@ public:
 	
 	void rescale(const glm::vec2 &scale) override { uvRescale(scale); }
 	void uvRescale(const glm::vec2 &scale);
+	// see MeshData::getMesh. every mesh of this container is tessellated with it. marks all meshes dirty when changed.
+	void setTessellationTolerance(float tolerance);
+	float getTessellationTolerance() const { return tessellation_tolerance_; }
 
-	void exportMesh(const std::filesystem::path &filepath, float resample_min_interval, const glm::vec2 &coord_size, bool only_visible=true) const;
+	bool exportMesh(const std::filesystem::path &filepath, float resample_min_interval, const glm::vec2 &coord_size, bool only_visible=true) const;
 	ofMesh getMesh(float resample_min_interval, const glm::vec2 &coord_size, ofRectangle *viewport=nullptr, bool only_visible=true) const;
 	ofMesh getMeshForExport(float resample_min_interval, const glm::vec2 &coord_size, bool only_visible=true) const;
+	// same as getMesh but kept on GPU and rebuilt only when any visible mesh or the visibility itself changed
+	const ofVboMesh& getRetainedMesh(float resample_min_interval, const glm::vec2 &coord_size, bool only_visible=true) const;
+protected:
+	void forEachIndexKey(const DataType &data, std::function<void(const void*)> func) const override {
+		func(&data);
+		func(data.uv_quad.get());
+		func(data.mesh.get());
+	}
+private:
+	mutable struct {
+		std::vector<std::pair<const DataType*, std::size_t>> state;
+		float resample_min_interval;
+		glm::vec2 coord_size;
+		bool is_valid=false;
+		ofVboMesh mesh;
+	} retained_;
+	float tessellation_tolerance_=0;
 };
 
 class BlendingData : public DataContainer<BlendingMesh>
@@ -201,19 +356,32 @@ public:
 	using MeshType = BlendingMesh::MeshType;
 	BlendingData() {
 		shader_ = std::make_shared<ofxBlendScreen::Shader>();
-		shader_->setup();
 	}
 	NamedData create(const std::string &name, const ofRectangle &frame, const float &default_inner_ratio);
 	NamedData find(std::shared_ptr<MeshType> mesh);
-	void exportMesh(const std::filesystem::path &filepath, float resample_min_interval, const glm::vec2 &coord_size, bool only_visible=true) const;
+	bool exportMesh(const std::filesystem::path &filepath, float resample_min_interval, const glm::vec2 &coord_size, bool only_visible=true) const;
 	ofMesh getMesh(float resample_min_interval, const glm::vec2 &coord_size, ofRectangle *viewport=nullptr, bool only_visible=true) const;
 	ofMesh getMeshForExport(float resample_min_interval, const glm::vec2 &coord_size, bool only_visible=true) const;
 
-	std::shared_ptr<ofxBlendScreen::Shader> getShader() const { return shader_; }
-	virtual void pack(std::ostream &stream, const glm::vec2 &scale) const override;
-	virtual void unpack(std::istream &stream, const glm::vec2 &scale) override;
+	// the shader program is built on first access so that the data can live without a GL context
+	std::shared_ptr<ofxBlendScreen::Shader> getShader() const {
+		if(!is_shader_setup_) {
+			shader_->setup();
+			is_shader_setup_ = true;
+		}
+		return shader_;
+	}
+	virtual void pack(ByteWriter &writer, const glm::vec2 &scale) const override;
+	virtual void unpack(ByteReader &reader, const glm::vec2 &scale) override;
+	std::shared_ptr<BlendingMesh> unpackOne(ByteReader &reader, const std::string &name, const glm::vec2 &scale) const override;
+protected:
+	void forEachIndexKey(const DataType &data, std::function<void(const void*)> func) const override {
+		func(&data);
+		func(data.mesh.get());
+	}
 private:
 	std::shared_ptr<ofxBlendScreen::Shader> shader_;
+	mutable bool is_shader_setup_=false;
 };
 
 extern template class DataContainer<WarpingMesh>;
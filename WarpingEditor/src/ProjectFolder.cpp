@@ -68,17 +68,29 @@ struct adl_serializer<ProjectFolder::Texture> {
 				j["type"] = "NDI";
 				j["arg"] = v.ndi;
 				break;
+			case ProjectFolder::Texture::SEQUENCE:
+				j["type"] = "Sequence";
+				j["arg"] = v.sequence.folder;
+				j["fps"] = v.sequence.fps;
+				break;
 		}
 		j["size_cache"] = v.size_cache;
 	}
 	static void from_json(const ofJson &j, ProjectFolder::Texture &v) {
 		auto upper_type = ofToUpper(getJsonValue<std::string>(j, "type", "File"));
 		if(upper_type == "FILE") {
+			v.type = ProjectFolder::Texture::FILE;
 			updateByJsonValue(v.file, j, "arg");
 		}
 		else if(upper_type == "NDI") {
+			v.type = ProjectFolder::Texture::NDI;
 			updateByJsonValue(v.ndi, j, "arg");
 		}
+		else if(upper_type == "SEQUENCE") {
+			v.type = ProjectFolder::Texture::SEQUENCE;
+			updateByJsonValue(v.sequence.folder, j, "arg");
+			updateByJsonValue(v.sequence.fps, j, "fps");
+		}
 		updateByJsonValue(v.size_cache, j, "size_cache");
 	}
 };
@@ -139,6 +151,21 @@ struct adl_serializer<ProjectFolder::Export::BlendShader> {
 		updateByJsonValue(v.filename, j, "filename");
 	}
 };
+template<>
+struct adl_serializer<ProjectFolder::Export::LookupTable> {
+	static void to_json(ofJson &j, const ProjectFolder::Export::LookupTable &v) {
+		j = {
+			{"enabled", v.enabled},
+			{"uv_filename", v.uv_filename},
+			{"blend_filename", v.blend_filename}
+		};
+	}
+	static void from_json(const ofJson &j, ProjectFolder::Export::LookupTable &v) {
+		updateByJsonValue(v.enabled, j, "enabled");
+		updateByJsonValue(v.uv_filename, j, "uv_filename");
+		updateByJsonValue(v.blend_filename, j, "blend_filename");
+	}
+};
 
 template<>
 struct adl_serializer<ProjectFolder::Export> {
@@ -148,7 +175,8 @@ struct adl_serializer<ProjectFolder::Export> {
 			{"is_arb", v.is_arb},
 			{"warp", v.warp},
 			{"blend", v.blend},
-			{"blend_shader", v.blend_shader}
+			{"blend_shader", v.blend_shader},
+			{"lut", v.lut}
 		};
 	}
 	static void from_json(const ofJson &j, ProjectFolder::Export &v) {
@@ -157,6 +185,7 @@ struct adl_serializer<ProjectFolder::Export> {
 		updateByJsonValue(v.warp, j, "warp");
 		updateByJsonValue(v.blend, j, "blend");
 		updateByJsonValue(v.blend_shader, j, "blend_shader");
+		updateByJsonValue(v.lut, j, "lut");
 	}
 };
 template<>
@@ -171,6 +200,17 @@ struct adl_serializer<ProjectFolder::Bridge> {
 	}
 };
 template<>
+struct adl_serializer<ProjectFolder::Tessellation> {
+	static void to_json(ofJson &j, const ProjectFolder::Tessellation &v) {
+		j = {
+			{"tolerance", v.tolerance}
+		};
+	}
+	static void from_json(const ofJson &j, ProjectFolder::Tessellation &v) {
+		updateByJsonValue(v.tolerance, j, "tolerance");
+	}
+};
+template<>
 struct adl_serializer<ProjectFolder::Backup> {
 	static void to_json(ofJson &j, const ProjectFolder::Backup &v) {
 		j = {
@@ -244,6 +284,7 @@ ofJson ProjectFolder::toJson() const
 		{"export", export_},
 		{"backup", backup_},
 		{"bridge", bridge_},
+		{"tessellation", tessellation_},
 		{"grid", grid_},
 		{"filename", filename_},
 		{"result", result_},
@@ -257,6 +298,7 @@ void ProjectFolder::loadJson(const ofJson &json)
 	updateByJsonValue(export_, json, "export");
 	updateByJsonValue(backup_, json, "backup");
 	updateByJsonValue(bridge_, json, "bridge");
+	updateByJsonValue(tessellation_, json, "tessellation");
 	updateByJsonValue(grid_, json, "grid");
 	updateByJsonValue(filename_, json, "filename");
 	updateByJsonValue(result_, json, "result");
@@ -275,7 +317,10 @@ void ProjectFolder::load() {
 	loadJson(ofLoadJson(getAbsolute(getProjFileName())));
 }
 void ProjectFolder::save() const {
-	ofSavePrettyJson(getAbsolute(getProjFileName()), toJson());
+	ofSavePrettyJson(getProjFilePath(), toJson());
+}
+std::string ProjectFolder::toJsonString() const {
+	return toJson().dump(4);
 }
 
 std::filesystem::path ProjectFolder::getBackupFilePath() const
@@ -297,4 +342,10 @@ void ProjectFolder::setTextureSourceNDI(const std::string &ndi_name)
 	texture_.type = Texture::NDI;
 	texture_.ndi = ndi_name;
 }
+void ProjectFolder::setTextureSourceSequence(const std::string &folder, float fps)
+{
+	texture_.type = Texture::SEQUENCE;
+	texture_.sequence.folder = folder;
+	texture_.sequence.fps = fps;
+}
 
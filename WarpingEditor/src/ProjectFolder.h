@@ -10,11 +10,15 @@ class ProjectFolder : public WorkFolder
 public:
 	struct Texture {
 		enum {
-			FILE, NDI
+			FILE, NDI, SEQUENCE
 		};
 		int type = FILE;
 		std::string file;
 		std::string ndi;
+		struct Sequence {
+			std::string folder;
+			float fps=30;
+		} sequence;
 		glm::ivec2 size_cache;
 	};
 	struct Viewport {
@@ -31,6 +35,12 @@ public:
 		struct BlendShader {
 			std::string filename="blend_shader.json";
 		} blend_shader;
+		// per pixel uv and blend maps at the bridge resolution, see render::LookupTable
+		struct LookupTable {
+			bool enabled=false;
+			std::string uv_filename="uv_map.flut";
+			std::string blend_filename="blend_map.flut";
+		} lut;
 	};
 	struct Backup {
 		bool enabled=true;
@@ -43,6 +53,10 @@ public:
 	struct Bridge {
 		glm::ivec2 resolution={1920,1080};
 	};
+	struct Tessellation {
+		// see WarpingData::setTessellationTolerance
+		float tolerance=0;
+	};
 	struct Result {
 		std::string editor_name="uv";
 		bool is_scale_to_viewport=false;
@@ -53,15 +67,20 @@ public:
 	void setup();
 	void load();
 	void save() const;
+	// same content as save writes
+	std::string toJsonString() const;
 	void backup() const;
 	
 	std::filesystem::path getDataFilePath() const { return getAbsolute(getDataFileName()+".maap"); }
 	std::string getDataFileName() const { return filename_; }
 	std::string getProjFileName() const { return "project.json"; }
+	std::filesystem::path getProjFilePath() const { return getAbsolute(getProjFileName()); }
 	
 	int getTextureType() const { return texture_.type; }
 	std::filesystem::path getTextureFilePath() const { return getAbsolute(texture_.file); }
 	const std::string& getTextureNDIName() const { return texture_.ndi; }
+	std::filesystem::path getTextureSequenceFolder() const { return getAbsolute(texture_.sequence.folder); }
+	float getTextureSequenceFps() const { return texture_.sequence.fps; }
 	glm::ivec2 getTextureSizeCache() const { return texture_.size_cache; }
 
 	glm::vec4 getResultViewport() const { return viewport_.result; }
@@ -75,6 +94,7 @@ public:
 	bool isResultShowCursor() const { return result_.is_show_cursor; }
 	
 	glm::ivec2 getBridgeResolution() const { return bridge_.resolution; }
+	float getTessellationTolerance() const { return tessellation_.tolerance; }
 	
 	ofxBlendScreen::Shader::Params getBlendParams() const { return blend_params_; }
 	
@@ -83,6 +103,7 @@ public:
 	Export::Mesh getExportWarpParam() const { return export_.warp; }
 	Export::Mesh getExportBlendParam() const { return export_.blend; }
 	Export::BlendShader getExportBlendShaderParam() const { return export_.blend_shader; }
+	Export::LookupTable getExportLookupTableParam() const { return export_.lut; }
 	
 	bool isBackupEnabled() const { return backup_.enabled; }
 	std::filesystem::path getBackupFolder() const { return getRelative(backup_.folder); }
@@ -95,6 +116,8 @@ public:
 	
 	void setTextureSourceFile(const std::string &file_name);
 	void setTextureSourceNDI(const std::string &ndi_name);
+	void setTextureSourceSequence(const std::string &folder, float fps);
+	void setTextureSequenceFps(float fps) { texture_.sequence.fps = fps; }
 	void setTextureSizeCache(const glm::vec2 size) { texture_.size_cache = size; }
 	
 	void setResultViewport(const glm::vec4 &viewport) { viewport_.result = viewport; }
@@ -108,6 +131,7 @@ public:
 	void setResultShowCursor(bool enable) { result_.is_show_cursor = enable; }
 	
 	void setBridgeResolution(glm::ivec2 resolution) { bridge_.resolution = resolution; }
+	void setTessellationTolerance(float tolerance) { tessellation_.tolerance = tolerance; }
 	
 	void setBlendParams(const ofxBlendScreen::Shader::Params &params) { blend_params_ = params; }
 
@@ -116,6 +140,7 @@ public:
 	void setExportWarpParam(const Export::Mesh &param) { export_.warp = param; }
 	void setExportBlendParam(const Export::Mesh &param) { export_.blend = param; }
 	void setExportBlendShaderParam(const Export::BlendShader &param) { export_.blend_shader = param; }
+	void setExportLookupTableParam(const Export::LookupTable &param) { export_.lut = param; }
 
 	void setUVGridData(const EditorBase::GridData &data) { grid_.uv = data; }
 	void setWarpGridData(const EditorBase::GridData &data) { grid_.warp = data; }
@@ -131,6 +156,7 @@ private:
 	Backup backup_;
 	Grid grid_;
 	Bridge bridge_;
+	Tessellation tessellation_;
 	Result result_;
 	std::string filename_;
 	ofxBlendScreen::Shader::Params blend_params_;
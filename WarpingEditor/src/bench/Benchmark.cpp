@@ -0,0 +1,331 @@
+#include "Benchmark.h"
+#include "MeshData.h"
+#include "MeshEditor.h"
+#include "ProjectFolder.h"
+#include "Undo.h"
+#include "ofMath.h"
+#include "ofLog.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+	std::string name;
+	std::size_t iterations;
+	double mean_ms, min_ms, p99_ms;
+	double throughput;
+	std::string unit;
+};
+
+template<typename Func>
+Result measure(const std::string &name, std::size_t iterations, double items_per_iteration, const std::string &unit, Func func)
+{
+	func();	// warm up
+	std::vector<double> elapsed(iterations);
+	for(auto &&e : elapsed) {
+		auto start = Clock::now();
+		func();
+		e = std::chrono::duration<double, std::milli>(Clock::now()-start).count();
+	}
+	std::sort(begin(elapsed), end(elapsed));
+	Result ret;
+	ret.name = name;
+	ret.iterations = iterations;
+	ret.mean_ms = std::accumulate(begin(elapsed), end(elapsed), 0.0)/iterations;
+	ret.min_ms = elapsed.front();
+	ret.p99_ms = elapsed[std::min(iterations-1, (std::size_t)(iterations*0.99))];
+	ret.throughput = ret.mean_ms > 0 ? items_per_iteration/(ret.mean_ms/1000.0) : 0;
+	ret.unit = unit;
+	return ret;
+}
+
+void printHeader(const std::string &title)
+{
+	std::cout << std::endl << "## " << title << std::endl;
+	std::cout << std::left << std::setw(44) << "case"
+	<< std::right << std::setw(8) << "iter"
+	<< std::setw(12) << "mean[ms]"
+	<< std::setw(12) << "min[ms]"
+	<< std::setw(12) << "p99[ms]"
+	<< std::setw(16) << "throughput" << std::endl;
+}
+void print(const Result &r)
+{
+	std::cout << std::left << std::setw(44) << r.name
+	<< std::right << std::setw(8) << r.iterations
+	<< std::fixed << std::setprecision(3)
+	<< std::setw(12) << r.mean_ms
+	<< std::setw(12) << r.min_ms
+	<< std::setw(12) << r.p99_ms
+	<< std::setprecision(1)
+	<< std::setw(16) << r.throughput << " " << r.unit << std::endl;
+}
+
+struct Project {
+	std::string name;
+	std::shared_ptr<WarpingData> warping = std::make_shared<WarpingData>();
+	std::shared_ptr<BlendingData> blending = std::make_shared<BlendingData>();
+	glm::vec2 tex_size={1920,1080};
+	glm::vec2 bridge_size={1920,1080};
+	float resample_interval=100;
+	
+	// same layout as GuiApp::packDataFile
+	void pack(ByteWriter &writer) const {
+		SaveData saver;
+		warping->setPackArg({1/tex_size.x, 1/tex_size.y});
+		saver.append((char *)"warp", warping);
+		blending->setPackArg({1/bridge_size.x, 1/bridge_size.y});
+		saver.append((char *)"blnd", blending);
+		saver.pack(writer);
+	}
+	void unpack(ByteReader &reader) {
+		SaveData loader;
+		warping->setUnpackArg(tex_size);
+		loader.append((char *)"warp", warping);
+		blending->setUnpackArg(bridge_size);
+		loader.append((char *)"blnd", blending);
+		loader.unpack(reader);
+	}
+};
+
+bool loadProject(const std::string &folder, Project &proj)
+{
+	ProjectFolder pf;
+	if(!pf.setRelative(folder) || !pf.isValid()) {
+		ofLogError("Benchmark") << "project folder not found: " << folder;
+		return false;
+	}
+	pf.setup();
+	proj.name = folder;
+	proj.tex_size = pf.getTextureSizeCache();
+	proj.bridge_size = pf.getBridgeResolution();
+	proj.resample_interval = pf.getExportWarpParam().max_mesh_size;
+	if(!SaveData::withFileReader(pf.getDataFilePath(), [&proj](ByteReader &reader) { proj.unpack(reader); })) {
+		ofLogError("Benchmark") << "data file not found: " << pf.getDataFilePath();
+		return false;
+	}
+	return true;
+}
+
+Project makeSyntheticProject(int num_meshes, const glm::ivec2 &num_cells)
+{
+	Project proj;
+	proj.name = "synthetic "+ofToString(num_meshes)+" meshes x "+ofToString(num_cells.x)+"x"+ofToString(num_cells.y)+" cells";
+	ofSeedRandom(0);
+	int cols = (int)std::ceil(std::sqrt(num_meshes));
+	glm::vec2 mesh_size = proj.tex_size/(float)cols;
+	glm::vec2 cell_size = mesh_size/glm::vec2(num_cells);
+	for(int i = 0; i < num_meshes; ++i) {
+		ofRectangle rect(mesh_size.x*(i%cols), mesh_size.y*(i/cols), mesh_size.x, mesh_size.y);
+		auto data = proj.warping->create("mesh", num_cells, rect).second;
+		auto &mesh = *data->mesh;
+		for(int r = 0; r <= mesh.getNumRows(); ++r) {
+			for(int c = 0; c <= mesh.getNumCols(); ++c) {
+				*mesh.getPoint(c, r).v += glm::vec3(ofRandom(-0.2f,0.2f)*cell_size.x, ofRandom(-0.2f,0.2f)*cell_size.y, 0);
+			}
+		}
+		data->setDirty();
+		proj.blending->create("blend", rect, 0.9f);
+	}
+	return proj;
+}
+
+class HitTestEditor : public MeshEditor
+{
+public:
+	using MeshEditor::getHover;
+	using MeshEditor::getRectHover;
+};
+
+void benchTessellation(Project &proj)
+{
+	printHeader("tessellation: "+proj.name);
+	auto &&warping = proj.warping->getData();
+	auto &&blending = proj.blending->getData();
+	std::size_t num_cells = 0;
+	for(auto &&m : warping) {
+		num_cells += m.second->mesh->getNumCols()*m.second->mesh->getNumRows();
+	}
+	float interval = proj.resample_interval;
+	print(measure("warp createMesh, 1 thread", 10, num_cells, "cells/s", [&]() {
+		for(auto &&m : warping) {
+			m.second->createMesh(interval, proj.tex_size);
+		}
+	}));
+	print(measure("warp getMeshForExport, parallel", 10, num_cells, "cells/s", [&]() {
+		proj.warping->getMeshForExport(interval, proj.tex_size, false);
+	}));
+	{
+		auto uniform = proj.warping->getMeshForExport(interval, proj.tex_size, false).getNumVertices();
+		proj.warping->setTessellationTolerance(0.5f);
+		print(measure("warp getMeshForExport, adaptive 0.5px", 10, num_cells, "cells/s", [&]() {
+			proj.warping->getMeshForExport(interval, proj.tex_size, false);
+		}));
+		auto adaptive = proj.warping->getMeshForExport(interval, proj.tex_size, false).getNumVertices();
+		proj.warping->setTessellationTolerance(0);
+		std::cout << "vertices: uniform " << uniform << ", adaptive " << adaptive << std::endl;
+	}
+	print(measure("warp getMesh, all dirty", 10, num_cells, "cells/s", [&]() {
+		for(auto &&m : warping) {
+			m.second->setDirty();
+		}
+		proj.warping->getMesh(interval, proj.tex_size, nullptr, false);
+	}));
+	if(!warping.empty()) {
+		auto edited = warping.front().second;
+		print(measure("warp getMesh, one point moved", 20, 1, "frames/s", [&]() {
+			*edited->mesh->getPoint(0, 0).v += glm::vec3(1,0,0);
+			edited->setDirty();
+			proj.warping->getMesh(interval, proj.tex_size, nullptr, false);
+		}));
+	}
+	print(measure("warp getMesh, cached", 100, 1, "frames/s", [&]() {
+		proj.warping->getMesh(interval, proj.tex_size, nullptr, false);
+	}));
+	print(measure("blend createMesh, 1 thread", 10, blending.size(), "meshes/s", [&]() {
+		for(auto &&m : blending) {
+			m.second->createMesh(interval, proj.bridge_size);
+		}
+	}));
+	print(measure("blend getMeshForExport, parallel", 10, blending.size(), "meshes/s", [&]() {
+		proj.blending->getMeshForExport(interval, proj.bridge_size, false);
+	}));
+}
+
+void benchSerialization(Project &proj)
+{
+	printHeader("serialization: "+proj.name);
+	ByteWriter packed;
+	proj.pack(packed);
+	std::string data = packed.str();
+	double mb = data.size()/(1024.0*1024.0);
+	print(measure("pack", 20, mb, "MB/s", [&]() {
+		ByteWriter writer;
+		proj.pack(writer);
+	}));
+	Project dst = proj;
+	dst.warping = std::make_shared<WarpingData>();
+	dst.blending = std::make_shared<BlendingData>();
+	print(measure("unpack", 20, mb, "MB/s", [&]() {
+		ByteReader reader(data.data(), data.size());
+		dst.unpack(reader);
+	}));
+	auto &&warping = proj.warping->getData();
+	if(!warping.empty()) {
+		auto name = warping.back().first;
+		print(measure("fetch last warping mesh", 20, 1, "meshes/s", [&]() {
+			ByteReader reader(data.data(), data.size());
+			if(auto chunk = SaveData::findChunk(reader, "warp")) {
+				proj.warping->unpackOne(*chunk, name, proj.tex_size);
+			}
+		}));
+	}
+}
+
+void benchUndo(Project &proj)
+{
+	printHeader("undo: "+proj.name);
+	Undo undo;
+	undo.setup([&](ByteWriter &writer) { proj.pack(writer); },
+			   [&](ByteReader &reader) { proj.unpack(reader); });
+	UndoDescriptor descriptor(undo);
+	print(measure("create snapshot", 20, 1, "snapshots/s", [&]() {
+		undo.create();
+	}));
+	print(measure("modification check, idle", 1000, 1, "checks/s", [&]() {
+		descriptor.getUndoStateDescriptor();
+	}));
+	auto &&warping = proj.warping->getData();
+	if(!warping.empty()) {
+		auto edited = warping.front().second;
+		print(measure("modification check, one point moved", 20, 1, "checks/s", [&]() {
+			*edited->mesh->getPoint(0, 0).v += glm::vec3(1,0,0);
+			edited->setDirty();
+			descriptor.getUndoStateDescriptor();
+			undo.store();
+		}));
+		std::cout << "history: " << undo.getUndoLength() << " states, " << undo.getDataSize()/1024 << "kB" << std::endl;
+	}
+	print(measure("undo + redo", 10, 1, "round trips/s", [&]() {
+		undo.undo();
+		undo.redo();
+	}));
+}
+
+void benchHitTest(Project &proj)
+{
+	printHeader("hit testing: "+proj.name);
+	HitTestEditor editor;
+	editor.setMeshData(proj.warping);
+	ofSeedRandom(0);
+	std::vector<glm::vec2> pos(1000);
+	for(auto &&p : pos) {
+		p = {ofRandom(proj.tex_size.x), ofRandom(proj.tex_size.y)};
+	}
+	print(measure("getHover", 10, pos.size(), "queries/s", [&]() {
+		for(auto &&p : pos) {
+			editor.getHover(p, false);
+		}
+	}));
+	print(measure("getRectHover 200x200", 10, pos.size(), "queries/s", [&]() {
+		for(auto &&p : pos) {
+			editor.getRectHover({p.x, p.y, 200, 200}, false);
+		}
+	}));
+	auto &&warping = proj.warping->getData();
+	if(!warping.empty()) {
+		auto edited = warping.front().second;
+		print(measure("getHover after an edit", 100, 1, "queries/s", [&]() {
+			edited->setDirty();
+			editor.getHover(pos.front(), false);
+		}));
+	}
+}
+
+void benchProject(Project &proj)
+{
+	std::size_t num_cells = 0;
+	for(auto &&m : proj.warping->getData()) {
+		num_cells += m.second->mesh->getNumCols()*m.second->mesh->getNumRows();
+	}
+	std::cout << std::endl << "# " << proj.name << ": "
+	<< proj.warping->getData().size() << " warping meshes (" << num_cells << " cells), "
+	<< proj.blending->getData().size() << " blending meshes" << std::endl;
+	benchTessellation(proj);
+	benchSerialization(proj);
+	benchUndo(proj);
+	benchHitTest(proj);
+}
+}
+
+namespace bench {
+int run(const std::vector<std::string> &args)
+{
+	std::vector<std::string> folders = args.empty() ? std::vector<std::string>{"testdata"} : args;
+	int failed = 0;
+	for(auto &&folder : folders) {
+		Project proj;
+		if(!loadProject(folder, proj)) {
+			++failed;
+			continue;
+		}
+		benchProject(proj);
+	}
+	if(args.empty()) {
+		for(auto &&size : std::vector<std::pair<int, glm::ivec2>>{
+			{16, {8,8}},
+			{64, {16,16}},
+			{256, {16,16}},
+		}) {
+			auto proj = makeSyntheticProject(size.first, size.second);
+			benchProject(proj);
+		}
+	}
+	return failed;
+}
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace bench {
+// measures the mesh pipeline without opening a window and prints the results to stdout.
+// args are project folders relative to the data folder. testdata and synthetic projects are used if empty.
+int run(const std::vector<std::string> &args);
+}
@@ -9,6 +9,10 @@
 #include "ofGraphics.h"
 #include "of3dUtils.h"
 #include "AppFunc.h"
+#include "SpatialGrid.h"
+#include "PointBatch.h"
+#include "TintedMeshDrawer.h"
+#include <unordered_map>
 
 class EditorBase : public ofxEditorFrame
 {
@@ -16,13 +20,7 @@ public:
 	void setup();
 	virtual void update();
 	virtual void draw() const{}
-	virtual void drawMesh(bool use_control_color) const {
-		beginShader();
-		tex_.bind();
-		getMesh(use_control_color).draw();
-		tex_.unbind();
-		endShader();
-	}
+	virtual void drawMesh(bool use_control_color) const {}
 	virtual void drawWorkArea(const ofFloatColor &color, bool fill) const {
 		auto size = getWorkAreaSize();
 		ofPushStyle();
@@ -34,7 +32,6 @@ public:
 
 	virtual void beginShader() const {}
 	virtual void endShader() const {}
-	virtual ofMesh getMesh(bool use_control_color) const { return {}; }
 	virtual void drawControl(float parent_scale) const {}
 	virtual void drawCursor() const;
 	virtual void drawBackground() const {
@@ -116,7 +113,7 @@ public:
 	
 	void setMeshData(std::shared_ptr<ContainerType> data) { data_ = data; }
 	virtual void draw() const override;
-	virtual ofMesh getMesh(bool use_control_color) const override;
+	virtual void drawMesh(bool use_control_color) const override;
 	virtual void drawControl(float parent_scale) const override;
 	
 	void setEnabledHoveringUneditablePoint(bool enable) { is_enabled_hovering_uneditable_point_ = enable; }
@@ -210,10 +207,26 @@ protected:
 	virtual void forEachMesh(std::function<void(std::shared_ptr<DataType>)> func) const;
 	virtual void forEachPoint(const DataType &data, std::function<void(const PointType&, IndexType)> func) const {}
 	
-	virtual ofMesh makeMeshFromMesh(const DataType &mesh, const ofColor &color) const { return ofMesh(); }
+	virtual void withMeshFromMesh(const DataType &mesh, std::function<void(const ofMesh&)> func) const {}
 	virtual ofMesh makeWireFromMesh(const DataType &mesh, const ofColor &color) const { return ofMesh(); }
-	ofMesh makeMeshFromPoint(const PointType &point, const ofColor &color, float point_size) const;
+	mutable PointBatch point_batch_;
+	TintedMeshDrawer tinted_drawer_;
+
+	// control points of each mesh in work coordinates, updated when the mesh's generation changes.
+	// only the points that have moved are moved in the grid; bounds may be larger than the points after that.
+	struct PointIndex {
+		bool is_valid=false;
+		std::size_t generation=0;
+		ofRectangle bounds;
+		SpatialGrid<IndexType> grid;
+		// in the order of forEachPoint, to find the moved points
+		std::vector<std::pair<PointType, IndexType>> points;
+	};
+	mutable std::unordered_map<const DataType*, PointIndex> point_index_;
+	const PointIndex& getPointIndex(const DataType &data) const;
+	void prunePointIndex() const;
 
+	// searches only within mouse_near_distance_ from pos
 	virtual std::pair<std::weak_ptr<MeshType>, IndexType> getNearestPoint(std::shared_ptr<DataType> data, const glm::vec2 &pos, float &distance2, bool filter_by_if_editable=true);
 	virtual std::shared_ptr<MeshType> getIfInside(std::shared_ptr<DataType> data, const glm::vec2 &pos, float &distance) { return nullptr; }
 	virtual std::map<std::weak_ptr<MeshType>, std::set<IndexType>, std::owner_less<std::weak_ptr<MeshType>>> getPointInsideRect(std::shared_ptr<DataType> data, const ofRectangle &rect, bool filter_by_if_editable=true);
@@ -427,40 +440,53 @@ inline void Editor<Data, Mesh, Index, Point>::procNewMouseEvent(const MouseEvent
 	}
 }
 template<typename Data, typename Mesh, typename Index, typename Point>
-ofMesh Editor<Data, Mesh, Index, Point>::getMesh(bool use_control_color) const
+void Editor<Data, Mesh, Index, Point>::drawMesh(bool use_control_color) const
 {
-	ofMesh mesh;
-	mesh.setMode(OF_PRIMITIVE_TRIANGLES);
-	auto meshes = data_->getVisibleData();
+	auto &&meshes = data_->getVisibleData();
+	beginShader();
+	tex_.bind();
 	if(use_control_color) {
-		ofMesh selected, hovered, others;
-		float alpha = 0.8f*255;
+		// the tint multiplies the vertex colors per draw, so the cached meshes are drawn as they are and the texel alpha still applies.
+		const float alpha = 0.8f;
+		std::vector<const DataType*> others, selected, hovered, selected_hovered;
 		for(auto &&mm : meshes) {
-			auto m = mm.second;
+			auto m = mm.second.get();
 			if(isSelectedMesh(*m)) {
-				ofColor color = ofColor::white;
-				if(isHoveredMesh(*m)) {
-					color.lerp(ofColor::yellow, 0.5f);
-				}
-				selected.append(makeMeshFromMesh(*m, {color, alpha}));
-			}
-			else if(isHoveredMesh(*m)) {
-				hovered.append(makeMeshFromMesh(*m, {ofColor::yellow, alpha}));
+				(isHoveredMesh(*m) ? selected_hovered : selected).push_back(m);
 			}
 			else {
-				others.append(makeMeshFromMesh(*m, {ofColor::gray, alpha}));
+				(isHoveredMesh(*m) ? hovered : others).push_back(m);
+			}
+		}
+		ofFloatColor selected_hovered_color = ofFloatColor::white;
+		selected_hovered_color.lerp(ofFloatColor::yellow, 0.5f);
+		ofPushStyle();
+		ofEnableBlendMode(OF_BLENDMODE_ALPHA);
+		// others, then selected, then hovered on top
+		for(auto &&group : std::vector<std::pair<ofFloatColor, const std::vector<const DataType*>*>>{
+			{ofFloatColor::gray, &others},
+			{ofFloatColor::white, &selected},
+			{selected_hovered_color, &selected_hovered},
+			{ofFloatColor::yellow, &hovered}
+		}) {
+			ofFloatColor tint(group.first, alpha);
+			for(auto &&m : *group.second) {
+				withMeshFromMesh(*m, [this, &tint](const ofMesh &mesh) {
+					tinted_drawer_.draw(mesh, tint);
+				});
 			}
 		}
-		mesh.append(others);
-		mesh.append(selected);
-		mesh.append(hovered);
+		ofPopStyle();
 	}
 	else {
 		for(auto &&mm : meshes) {
-			mesh.append(makeMeshFromMesh(*mm.second, ofColor::white));
+			withMeshFromMesh(*mm.second, [](const ofMesh &mesh) {
+				mesh.draw();
+			});
 		}
 	}
-	return mesh;
+	tex_.unbind();
+	endShader();
 }
 template<typename Data, typename Mesh, typename Index, typename Point>
 void Editor<Data, Mesh, Index, Point>::drawWire() const
@@ -468,7 +494,7 @@ void Editor<Data, Mesh, Index, Point>::drawWire() const
 	ofMesh mesh;
 	mesh.setMode(OF_PRIMITIVE_LINES);
 
-	auto meshes = data_->getVisibleData();
+	auto &&meshes = data_->getVisibleData();
 	for(auto &&mm : meshes) {
 		auto m = mm.second;
 		mesh.append(makeWireFromMesh(*m, ofColor::white));
@@ -479,9 +505,9 @@ template<typename Data, typename Mesh, typename Index, typename Point>
 void Editor<Data, Mesh, Index, Point>::drawPoint(bool only_editable_point, float parent_scale) const
 {
 	float point_size = mouse_near_distance_/parent_scale;
-	ofMesh mesh;
-	mesh.setMode(OF_PRIMITIVE_TRIANGLES);
-	auto meshes = data_->getVisibleData();
+	auto &&batch = point_batch_;
+	batch.clear();
+	auto &&meshes = data_->getVisibleData();
 	for(auto &&mm : meshes) {
 		auto m = mm.second;
 		forEachPoint(*m, [&](const PointType &point, IndexType i) {
@@ -489,15 +515,15 @@ void Editor<Data, Mesh, Index, Point>::drawPoint(bool only_editable_point, float
 				return;
 			}
 			if(isSelectedPoint(*m, i)) {
-				mesh.append(makeMeshFromPoint(point, ofColor::white, point_size));
+				batch.add(point, ofColor::white, point_size);
 			}
 			if(isHoveredPoint(*m, i) || isRectHoveredPoint(*m, i)) {
-				mesh.append(makeMeshFromPoint(point, {ofColor::yellow, 128}, point_size));
+				batch.add(point, ofColor(ofColor::yellow, 128), point_size);
 			}
-			mesh.append(makeMeshFromPoint(point, {ofColor::gray, 128}, point_size));
+			batch.add(point, ofColor(ofColor::gray, 128), point_size);
 		});
 	};
-	mesh.draw();
+	batch.draw();
 }
 template<typename Data, typename Mesh, typename Index, typename Point>
 void Editor<Data, Mesh, Index, Point>::drawDragRect() const
@@ -578,20 +604,99 @@ void Editor<Data, Mesh, Index, Point>::drawControl(float parent_scale) const
 	drawPoint(!is_enabled_hovering_uneditable_point_, parent_scale);
 }
 
+template<typename Data, typename Mesh, typename Index, typename Point>
+auto Editor<Data, Mesh, Index, Point>::getPointIndex(const DataType &data) const -> const PointIndex&
+{
+	auto &&index = point_index_[&data];
+	if(index.is_valid && index.generation == data.getGeneration()) {
+		return index;
+	}
+	std::vector<std::pair<PointType, IndexType>> points;
+	points.reserve(index.points.size());
+	forEachPoint(data, [&](const PointType &point, IndexType i) {
+		points.emplace_back(point, i);
+	});
+	index.generation = data.getGeneration();
+	bool is_same_set = index.is_valid && points.size() == index.points.size()
+	&& std::equal(begin(points), end(points), begin(index.points), [](const std::pair<PointType, IndexType> &a, const std::pair<PointType, IndexType> &b) {
+		return a.second == b.second;
+	});
+	if(is_same_set) {
+		bool moved = true;
+		for(std::size_t i = 0; i < points.size() && moved; ++i) {
+			auto &&p = points[i];
+			if(p.first != index.points[i].first) {
+				moved = index.grid.move(index.points[i].first, p.first, p.second);
+				index.bounds.growToInclude(p.first);
+			}
+		}
+		if(moved) {
+			index.points = std::move(points);
+			return index;
+		}
+	}
+	if(points.empty()) {
+		index.bounds = ofRectangle();
+	}
+	else {
+		index.bounds = ofRectangle(points[0].first, 0, 0);
+		for(auto &&p : points) {
+			index.bounds.growToInclude(p.first);
+		}
+	}
+	// aim for about one point per cell
+	float cell_size = sqrt(std::max(index.bounds.getArea(), 1.f) / std::max<std::size_t>(points.size(), 1));
+	index.grid.setup(cell_size);
+	for(auto &&p : points) {
+		index.grid.insert(p.first, p.second);
+	}
+	index.points = std::move(points);
+	index.is_valid = true;
+	return index;
+}
+
+template<typename Data, typename Mesh, typename Index, typename Point>
+void Editor<Data, Mesh, Index, Point>::prunePointIndex() const
+{
+	auto &&meshes = data_->getData();
+	if(point_index_.size() <= meshes.size()) {
+		return;
+	}
+	std::set<const DataType*> alive;
+	for(auto &&m : meshes) {
+		alive.insert(m.second.get());
+	}
+	for(auto it = begin(point_index_); it != end(point_index_);) {
+		if(alive.find(it->first) == end(alive)) {
+			it = point_index_.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
 template<typename Data, typename Mesh, typename Index, typename Point>
 std::pair<std::weak_ptr<Mesh>, Index> Editor<Data, Mesh, Index, Point>::getNearestPoint(std::shared_ptr<DataType> data, const glm::vec2 &pos, float &distance2, bool filter_by_if_editable)
 {
 	std::pair<std::weak_ptr<MeshType>, IndexType> ret;
 	distance2 = std::numeric_limits<float>::max();
 	auto p = getIn(pos);
-	forEachPoint(*data, [&](const PointType &point, IndexType index) {
-		if(filter_by_if_editable && !isEditablePoint(*data, index)) {
+	float radius = mouse_near_distance_/getScale();
+	ofRectangle area(p.x-radius, p.y-radius, radius*2, radius*2);
+	auto &&index = getPointIndex(*data);
+	auto &&bounds = index.bounds;
+	if(area.getMaxX() < bounds.getMinX() || bounds.getMaxX() < area.getMinX() || area.getMaxY() < bounds.getMinY() || bounds.getMaxY() < area.getMinY()) {
+		return ret;
+	}
+	index.grid.query(area, [&](const glm::vec2 &point, const IndexType &i) {
+		if(filter_by_if_editable && !isEditablePoint(*data, i)) {
 			return;
 		}
 		float d2 = glm::distance2(point, p);
 		if(d2 < distance2) {
 			std::weak_ptr<MeshType> weak = getMeshType(*data);
-			std::pair<std::weak_ptr<MeshType>, IndexType> tmp{weak, index};
+			std::pair<std::weak_ptr<MeshType>, IndexType> tmp{weak, i};
 			swap(ret, tmp);
 			distance2 = d2;
 		}
@@ -603,12 +708,15 @@ template<typename Data, typename Mesh, typename Index, typename Point>
 std::map<std::weak_ptr<Mesh>, std::set<Index>, std::owner_less<std::weak_ptr<Mesh>>> Editor<Data, Mesh, Index, Point>::getPointInsideRect(std::shared_ptr<DataType> data, const ofRectangle &rect, bool filter_by_if_editable)
 {
 	std::map<std::weak_ptr<MeshType>, std::set<IndexType>, std::owner_less<std::weak_ptr<MeshType>>> ret;
-	forEachPoint(*data, [&](const PointType &point, IndexType index) {
-		if(filter_by_if_editable && !isEditablePoint(*data, index)) {
+	ofRectangle rect_in{getIn(rect.getTopLeft()), getIn(rect.getBottomRight())};
+	rect_in.standardize();
+	auto &&index = getPointIndex(*data);
+	index.grid.query(rect_in, [&](const glm::vec2 &point, const IndexType &i) {
+		if(filter_by_if_editable && !isEditablePoint(*data, i)) {
 			return;
 		}
 		if(rect.inside(getOut(point))) {
-			ret[getMeshType(*data)].insert(index);
+			ret[getMeshType(*data)].insert(i);
 		}
 	});
 	return ret;
@@ -618,17 +726,15 @@ template<typename Data, typename Mesh, typename Index, typename Point>
 typename Editor<Data, Mesh, Index, Point>::OpHover Editor<Data, Mesh, Index, Point>::getHover(const glm::vec2 &screen_pos, bool only_editable_point)
 {
 	auto &&data = *data_;
-	auto &&meshes = data.getData();
+	auto &&meshes = data.getEditableData();
+	prunePointIndex();
 
 	OpHover ret;
 	float max_distance = std::numeric_limits<float>::max();
 	for(auto &&m : meshes) {
-		if(!data.isEditable(m.second)) {
-			continue;
-		}
 		const float threshold = pow(mouse_near_distance_/getScale(), 2);
 		float distance;
-		auto nearest = getNearestPoint(m.second, mouse_.pos, distance, only_editable_point);
+		auto nearest = getNearestPoint(m.second, screen_pos, distance, only_editable_point);
 		if(max_distance >= distance && distance < threshold) {
 			ret.point = nearest;
 			max_distance = distance;
@@ -636,12 +742,14 @@ typename Editor<Data, Mesh, Index, Point>::OpHover Editor<Data, Mesh, Index, Poi
 	}
 	max_distance = std::numeric_limits<float>::max();
 	if(ret.point.first.expired()) {
+		auto p = getIn(screen_pos);
 		for(auto &&m : meshes) {
-			if(!data.isEditable(m.second)) {
+			auto &&bounds = getPointIndex(*m.second).bounds;
+			if(p.x < bounds.getMinX() || bounds.getMaxX() < p.x || p.y < bounds.getMinY() || bounds.getMaxY() < p.y) {
 				continue;
 			}
 			float distance;
-			auto mesh = getIfInside(m.second, mouse_.pos, distance);
+			auto mesh = getIfInside(m.second, screen_pos, distance);
 			if(mesh && max_distance >= distance) {
 				ret.mesh = mesh;
 				max_distance = distance;
@@ -654,13 +762,10 @@ typename Editor<Data, Mesh, Index, Point>::OpHover Editor<Data, Mesh, Index, Poi
 template<typename Data, typename Mesh, typename Index, typename Point>
 typename Editor<Data, Mesh, Index, Point>::OpRect Editor<Data, Mesh, Index, Point>::getRectHover(const ofRectangle &screen_rect, bool only_editable_point)
 {
-	auto &&data = *data_;
-	auto &&meshes = data.getData();
+	auto &&meshes = data_->getEditableData();
+	prunePointIndex();
 	OpRect ret;
 	for(auto &&m : meshes) {
-		if(!data.isEditable(m.second)) {
-			continue;
-		}
 		auto tmp = getPointInsideRect(m.second, screen_rect, only_editable_point);
 		ret.point.insert(begin(tmp), end(tmp));
 	}
@@ -737,27 +842,6 @@ void Editor<Data, Mesh, Index, Point>::forEachMesh(std::function<void(std::share
 }
 
 
-template<typename Data, typename Mesh, typename Index, typename Point>
-ofMesh Editor<Data, Mesh, Index, Point>::makeMeshFromPoint(const PointType &point, const ofColor &color, float point_size) const
-{
-	ofMesh ret;
-	ret.setMode(OF_PRIMITIVE_TRIANGLES);
-	const int resolution = 16;
-	float angle = TWO_PI/(float)resolution;
-	for(int i = 0; i < resolution; ++i) {
-		ret.addIndex((ofIndexType)ret.getNumVertices());
-		ret.addVertex(glm::vec3(point+glm::vec2(cos(angle*i), sin(angle*i))*point_size,0));
-		ret.addIndex((ofIndexType)ret.getNumVertices());
-		ret.addVertex(glm::vec3(point,0));
-		ret.addIndex((ofIndexType)ret.getNumVertices());
-		ret.addVertex(glm::vec3(point+glm::vec2(cos(angle*(i+1)), sin(angle*(i+1)))*point_size,0));
-		ret.addColor(color);
-		ret.addColor(color);
-		ret.addColor(color);
-	}
-	return ret;
-}
-
 template<typename Data, typename Mesh, typename Index, typename Point>
 std::pair<bool, glm::vec2> Editor<Data, Mesh, Index, Point>::gui2DPanel(const std::string &label_str, const float v_min[2], const float v_max[2], const std::vector<std::pair<std::string, std::vector<ImGui::DragScalarAsParam>>> &params) const
 {
@@ -34,7 +34,7 @@ void BlendingEditor::forEachPoint(const DataType &data, std::function<void(const
 		}
 	}
 }
-ofMesh BlendingEditor::makeMeshFromMesh(const DataType &data, const ofColor &color) const
+void BlendingEditor::withMeshFromMesh(const DataType &data, std::function<void(const ofMesh&)> func) const
 {
 	const float min_interval = 100;
 	float mesh_resample_interval = std::max<float>(min_interval, (getIn({min_interval,0})-getIn({0,0})).x);
@@ -44,12 +44,7 @@ ofMesh BlendingEditor::makeMeshFromMesh(const DataType &data, const ofColor &col
 	glm::vec2 tex_scale = tex_data.textureTarget == GL_TEXTURE_RECTANGLE_ARB
 	? glm::vec2(1,1)
 	: glm::vec2(1/tex_data.tex_w, 1/tex_data.tex_h);
-	ofMesh ret = data.getMesh(mesh_resample_interval, tex_scale, &viewport_in);
-	auto &colors = ret.getColors();
-	for(auto &&c : colors) {
-		c = c*color;
-	}
-	return ret;
+	data.withLODMesh(mesh_resample_interval, tex_scale, &viewport_in, func);
 }
 ofMesh BlendingEditor::makeWireFromMesh(const DataType &data, const ofColor &color) const
 {
@@ -160,10 +155,14 @@ void BlendingEditor::gui()
 	if(Begin("Blending")) {
 		if(TreeNode("shader")) {
 			auto &p = data_->getShader()->getParams();
-			SliderFloat("blend_power", &p.blend_power, 0, 2);
-			SliderFloat("luminance_control", &p.luminance_control, 0, 1);
-			SliderFloat3("gamma", &p.gamma[0], 0, 3);
-			ColorEdit3("base_color", &p.base_color[0]);
+			bool edited = false;
+			edited |= SliderFloat("blend_power", &p.blend_power, 0, 2);
+			edited |= SliderFloat("luminance_control", &p.luminance_control, 0, 1);
+			edited |= SliderFloat3("gamma", &p.gamma[0], 0, 3);
+			edited |= ColorEdit3("base_color", &p.base_color[0]);
+			if(edited) {
+				data_->setModified();
+			}
 			TreePop();
 		}
 		if(BeginTabBar("#tab")) {
@@ -12,7 +12,7 @@ public:
 	void movePoint(MeshType &mesh, IndexType index, const glm::vec2 &delta) override;
 	std::shared_ptr<MeshType> getMeshType(const DataType &data) const override;
 	void forEachPoint(const DataType &data, std::function<void(const PointType&, IndexType)> func) const override;
-	ofMesh makeMeshFromMesh(const DataType &data, const ofColor &color) const override;
+	void withMeshFromMesh(const DataType &data, std::function<void(const ofMesh&)> func) const override;
 	ofMesh makeWireFromMesh(const DataType &data, const ofColor &color) const override;
 
 	std::set<IndexType> getIndices(std::shared_ptr<MeshType> mesh) const override;
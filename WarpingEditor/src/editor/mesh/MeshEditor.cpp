@@ -102,7 +102,7 @@ void MeshEditor::movePointCoord(MeshType &mesh, IndexType index, const glm::vec2
 }
 
 
-ofMesh MeshEditor::makeMeshFromMesh(const DataType &data, const ofColor &color) const
+void MeshEditor::withMeshFromMesh(const DataType &data, std::function<void(const ofMesh&)> func) const
 {
 	const float min_interval = 100;
 	float mesh_resample_interval = std::max<float>(min_interval, (getIn({min_interval,0})-getIn({0,0})).x);
@@ -112,12 +112,7 @@ ofMesh MeshEditor::makeMeshFromMesh(const DataType &data, const ofColor &color)
 	glm::vec2 tex_scale = tex_data.textureTarget == GL_TEXTURE_RECTANGLE_ARB
 	? glm::vec2(1,1)
 	: glm::vec2(1/tex_data.tex_w, 1/tex_data.tex_h);
-	ofMesh ret = data.getMesh(mesh_resample_interval, tex_scale, &viewport_in);
-	auto &colors = ret.getColors();
-	for(auto &&c : colors) {
-		c = c*color;
-	}
-	return ret;
+	data.withLODMesh(mesh_resample_interval, tex_scale, &viewport_in, func, data_->getTessellationTolerance());
 }
 
 ofMesh MeshEditor::makeWireFromMesh(const DataType &data, const ofColor &color) const
@@ -168,21 +168,23 @@ void WarpingMeshEditor::drawControl(float parent_scale) const
 			float point_size = mouse_near_distance_/parent_scale;
 			float cross_size = point_size*4;
 			float cross_width = point_size/2.f;
+			auto &&batch = point_batch_;
+			batch.clear();
 			ofMesh mesh;
 			mesh.setMode(OF_PRIMITIVE_TRIANGLES);
 			forEachMesh([&](std::shared_ptr<DataType> m) {
 				forEachPoint(*m, [&](const PointType &point, IndexType i) {
 					if(isCorner(*m->mesh, i)) {
-						mesh.append(makeMeshFromPoint(point, ofColor::black, point_size/2.f));
+						batch.add(point, ofColor::black, point_size/2.f);
 					}
 					else if(isEditablePoint(*m, i)) {
-						mesh.append(makeMeshFromPoint(point, {ofColor::white, 128}, point_size));
+						batch.add(point, ofColor(ofColor::white, 128), point_size);
 						if(isHoveredPoint(*m, i)) {
 							mesh.append(makeCross(point, ofColor::red, cross_size, cross_width, 45));
 						}
 					}
 					else {
-						mesh.append(makeMeshFromPoint(point, {ofColor::green, 128}, point_size/2.f));
+						batch.add(point, ofColor(ofColor::green, 128), point_size/2.f);
 						if(isHoveredPoint(*m, i)) {
 							mesh.append(makeCross(point, ofColor::green, cross_size, cross_width, 0));
 						}
@@ -192,6 +194,7 @@ void WarpingMeshEditor::drawControl(float parent_scale) const
 			if(is_div_point_valid_) {
 				mesh.append(makeCross(div_point_, ofColor::green, cross_size, cross_width, 0));
 			}
+			batch.draw();
 			mesh.draw();
 		}	break;
 	}
@@ -50,7 +50,7 @@ void UVEditor::movePoint(MeshType &mesh, IndexType index, const glm::vec2 &delta
 }
 
 
-ofMesh UVEditor::makeMeshFromMesh(const DataType &data, const ofColor &color) const
+void UVEditor::withMeshFromMesh(const DataType &data, std::function<void(const ofMesh&)> func) const
 {
 	auto mesh = *data.uv_quad;
 	ofMesh ret;
@@ -61,12 +61,12 @@ ofMesh UVEditor::makeMeshFromMesh(const DataType &data, const ofColor &color) co
 	for(int i = 0; i < mesh.size(); ++i) {
 		ret.addTexCoord(coord[i]);
 		ret.addVertex(glm::vec3(vert[i],0));
-		ret.addColor(color);
+		ret.addColor(ofColor::white);
 	}
 	for(auto i : {0,2,1,1,2,3}) {
 		ret.addIndex(i);
 	}
-	return ret;
+	func(ret);
 }
 
 
@@ -12,7 +12,7 @@ public:
 	std::shared_ptr<MeshType> getIfInside(std::shared_ptr<DataType> data, const glm::vec2 &pos, float &distance) override;
 	void moveMesh(MeshType &mesh, const glm::vec2 &delta) override;
 	void movePoint(MeshType &mesh, IndexType index, const glm::vec2 &delta) override;
-	ofMesh makeMeshFromMesh(const DataType &data, const ofColor &color) const override;
+	void withMeshFromMesh(const DataType &data, std::function<void(const ofMesh&)> func) const override;
 	ofMesh makeWireFromMesh(const DataType &data, const ofColor &color) const override;
 	std::set<IndexType> getIndices(std::shared_ptr<MeshType> mesh) const override;
 	void gui() override;
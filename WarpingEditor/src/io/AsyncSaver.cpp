@@ -0,0 +1,191 @@
+#include "AsyncSaver.h"
+#include "ofConstants.h"
+#include "ofLog.h"
+#include "imgui.h"
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+#ifdef TARGET_WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+// writes into a temporary file and renames it over the destination after it reached the disk,
+// so that a crash while saving never leaves a truncated file behind
+bool writeSynced(const std::filesystem::path &path, const std::vector<char> &data, std::string &error)
+{
+	auto tmp_path = path;
+	tmp_path += ".tmp";
+	std::FILE *fp = std::fopen(tmp_path.string().c_str(), "wb");
+	if(!fp) {
+		error = "can't open " + tmp_path.string();
+		return false;
+	}
+	bool ok = std::fwrite(data.data(), 1, data.size(), fp) == data.size() && std::fflush(fp) == 0;
+#ifdef TARGET_WIN32
+	ok = ok && _commit(_fileno(fp)) == 0;
+#else
+	ok = ok && fsync(fileno(fp)) == 0;
+#endif
+	ok = std::fclose(fp) == 0 && ok;
+	std::error_code ec;
+	if(!ok) {
+		std::filesystem::remove(tmp_path, ec);
+		error = "failed to write " + path.string();
+		return false;
+	}
+	std::filesystem::rename(tmp_path, path, ec);
+	if(ec) {
+		error = "failed to replace " + path.string() + ": " + ec.message();
+		return false;
+	}
+	return true;
+}
+// removes the oldest files with the same extension in the same folder as backup_path beyond the limit
+void pruneBackups(const std::filesystem::path &backup_path, std::size_t limit)
+{
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	std::vector<std::pair<fs::file_time_type, fs::path>> files;
+	for(auto &&entry : fs::directory_iterator(backup_path.parent_path(), ec)) {
+		if(entry.is_regular_file(ec) && entry.path().extension() == backup_path.extension()) {
+			files.emplace_back(entry.last_write_time(ec), entry.path());
+		}
+	}
+	if(files.size() <= limit) {
+		return;
+	}
+	std::sort(begin(files), end(files));
+	for(std::size_t i = 0; i < files.size()-limit; ++i) {
+		fs::remove(files[i].second, ec);
+	}
+}
+}
+
+AsyncSaver::AsyncSaver()
+{
+	worker_ = std::thread(&AsyncSaver::threadFunc, this);
+}
+
+AsyncSaver::~AsyncSaver()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		is_exiting_ = true;
+	}
+	wake_.notify_all();
+	worker_.join();
+}
+
+void AsyncSaver::save(Request &&request)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		pending_ = std::make_unique<Request>(std::move(request));
+		status_.state = SAVING;
+	}
+	wake_.notify_all();
+}
+
+void AsyncSaver::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	idle_.wait(lock, [this]{ return !pending_ && !is_writing_; });
+}
+
+bool AsyncSaver::isBusy() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return pending_ || is_writing_;
+}
+
+AsyncSaver::Status AsyncSaver::getStatus() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return status_;
+}
+
+void AsyncSaver::threadFunc()
+{
+	while(true) {
+		std::unique_ptr<Request> request;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			// what has been requested is still written on exit
+			wake_.wait(lock, [this]{ return pending_ || is_exiting_; });
+			if(!pending_) {
+				return;
+			}
+			request = std::move(pending_);
+			is_writing_ = true;
+		}
+		process(*request);
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			is_writing_ = false;
+		}
+		idle_.notify_all();
+	}
+}
+
+void AsyncSaver::process(const Request &request)
+{
+	std::string error;
+	for(auto &&file : request.files) {
+		std::error_code ec;
+		std::filesystem::create_directories(file.path.parent_path(), ec);
+		if(!writeSynced(file.path, file.data, error)) {
+			setStatus(FAILED, error);
+			return;
+		}
+	}
+	if(request.do_backup && request.backup_file_index < request.files.size()) {
+		std::error_code ec;
+		std::filesystem::create_directories(request.backup_path.parent_path(), ec);
+		if(!writeSynced(request.backup_path, request.files[request.backup_file_index].data, error)) {
+			setStatus(FAILED, error);
+			return;
+		}
+		if(request.backup_limit > 0) {
+			pruneBackups(request.backup_path, request.backup_limit);
+		}
+	}
+	setStatus(SAVED, "");
+}
+
+void AsyncSaver::setStatus(State state, const std::string &message)
+{
+	if(state == FAILED) {
+		ofLogError("AsyncSaver") << message;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	// a newer request is already waiting, so it is still saving
+	status_.state = pending_ ? SAVING : state;
+	status_.message = message;
+	status_.time = std::chrono::system_clock::now();
+}
+
+void AsyncSaver::gui() const
+{
+	using namespace ImGui;
+	auto status = getStatus();
+	char time_str[16] = "";
+	auto time = std::chrono::system_clock::to_time_t(status.time);
+	std::strftime(time_str, sizeof(time_str), "%H:%M:%S", std::localtime(&time));
+	switch(status.state) {
+		case IDLE:
+			TextDisabled("%s", "not saved yet");
+			break;
+		case SAVING:
+			Text("%s", "saving...");
+			break;
+		case SAVED:
+			Text("saved at %s", time_str);
+			break;
+		case FAILED:
+			TextColored(ImVec4(1,0.3f,0.3f,1), "failed at %s: %s", time_str, status.message.c_str());
+			break;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+
+// writes project snapshots on a worker thread.
+// snapshots are taken on the caller's thread, so the worker only touches bytes and paths.
+// one snapshot can wait while another is being written; a newer request replaces the waiting one.
+class AsyncSaver
+{
+public:
+	struct File {
+		std::filesystem::path path;
+		std::vector<char> data;
+	};
+	struct Request {
+		std::vector<File> files;
+		// copy of one of the files, written with the same data under backup_path
+		std::size_t backup_file_index=0;
+		std::filesystem::path backup_path;
+		// older backups in the same folder with the same extension are removed beyond this. 0 keeps all.
+		int backup_limit=0;
+		bool do_backup=false;
+	};
+	enum State {
+		IDLE,
+		SAVING,
+		SAVED,
+		FAILED
+	};
+	struct Status {
+		State state=IDLE;
+		std::string message;
+		std::chrono::system_clock::time_point time;
+	};
+
+	AsyncSaver();
+	// writes what has been requested before returning
+	~AsyncSaver();
+	AsyncSaver(const AsyncSaver&) = delete;
+	AsyncSaver& operator=(const AsyncSaver&) = delete;
+
+	void save(Request &&request);
+	// blocks until nothing is pending or being written
+	void wait();
+	bool isBusy() const;
+	Status getStatus() const;
+	void gui() const;
+private:
+	std::thread worker_;
+	mutable std::mutex mutex_;
+	std::condition_variable wake_, idle_;
+	std::unique_ptr<Request> pending_;
+	bool is_writing_=false;
+	bool is_exiting_=false;
+	Status status_;
+
+	void threadFunc();
+	void process(const Request &request);
+	void setStatus(State state, const std::string &message);
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <streambuf>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+
+namespace byteorder {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool is_little_endian = false;
+#else
+constexpr bool is_little_endian = true;
+#endif
+template<typename T>
+T swap(T t) {
+	char b[sizeof(T)];
+	std::memcpy(b, &t, sizeof(T));
+	std::reverse(b, b+sizeof(T));
+	std::memcpy(&t, b, sizeof(T));
+	return t;
+}
+// converts between host and little endian. same function both ways.
+template<typename T>
+T little(T t) { return is_little_endian ? t : swap(t); }
+}
+
+// contiguous byte arena for serialization.
+// plain values and arrays are appended with memcpy; stream() exposes the same arena
+// to code that only speaks std::ostream (e.g. ofx::mapper::Mesh::pack) without an extra copy.
+class ByteWriter : private std::streambuf
+{
+public:
+	ByteWriter():stream_(this){}
+	ByteWriter(const ByteWriter&) = delete;
+	ByteWriter& operator=(const ByteWriter&) = delete;
+
+	void write(const void *src, std::size_t size) {
+		if(pos_+size > data_.size()) {
+			if(pos_+size > data_.capacity()) {
+				data_.reserve(std::max(data_.capacity()*2, pos_+size));
+			}
+			data_.resize(pos_+size);
+		}
+		std::memcpy(data_.data()+pos_, src, size);
+		pos_ += size;
+	}
+	template<typename T> void write(const T &t) { write(&t, sizeof(T)); }
+	template<typename T> void writeArray(const T *t, std::size_t num) { write(t, sizeof(T)*num); }
+	// fixed byte order for arithmetic values. a plain copy on little endian hosts.
+	template<typename T> void writeLE(T t) { write(byteorder::little(t)); }
+	template<typename T> void writeArrayLE(const T *t, std::size_t num) {
+		if(byteorder::is_little_endian) {
+			writeArray(t, num);
+			return;
+		}
+		for(std::size_t i = 0; i < num; ++i) {
+			writeLE(t[i]);
+		}
+	}
+	template<typename T> void writeAtLE(std::size_t pos, T t) { writeAt(pos, byteorder::little(t)); }
+	// overwrites bytes already written, e.g. a size placeholder
+	template<typename T> void writeAt(std::size_t pos, const T &t) { std::memcpy(data_.data()+pos, &t, sizeof(T)); }
+
+	std::size_t tell() const { return pos_; }
+	std::size_t size() const { return data_.size(); }
+	const char* data() const { return data_.data(); }
+	void reserve(std::size_t size) { data_.reserve(size); }
+	void clear() { data_.clear(); pos_ = 0; }
+	std::string str() const { return {data_.data(), data_.size()}; }
+	// moves the written bytes out, leaving the writer empty
+	std::vector<char> release() { pos_ = 0; return std::move(data_); }
+
+	std::ostream& stream() { return stream_; }
+private:
+	std::vector<char> data_;
+	std::size_t pos_=0;
+	std::ostream stream_;
+
+	std::streamsize xsputn(const char *s, std::streamsize n) override {
+		write(s, n);
+		return n;
+	}
+	int_type overflow(int_type c) override {
+		if(!traits_type::eq_int_type(c, traits_type::eof())) {
+			char ch = traits_type::to_char_type(c);
+			write(&ch, 1);
+		}
+		return traits_type::not_eof(c);
+	}
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+		off_type base = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? pos_ : data_.size();
+		return seekpos(base+off, which);
+	}
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+		if(!(which & std::ios_base::out) || pos < 0 || std::size_t(pos) > data_.size()) {
+			return pos_type(off_type(-1));
+		}
+		pos_ = pos;
+		return pos;
+	}
+};
+
+// read cursor over a byte span that it does not own.
+// the span has to outlive the reader; stream() shares the cursor for std::istream based decoders.
+class ByteReader : private std::streambuf
+{
+public:
+	ByteReader(const char *data, std::size_t size):stream_(this) {
+		char *p = const_cast<char*>(data);
+		setg(p, p, p+size);
+	}
+	ByteReader(const ByteReader&) = delete;
+	ByteReader& operator=(const ByteReader&) = delete;
+
+	// fails without consuming anything if there are not enough bytes left
+	bool read(void *dst, std::size_t size) {
+		if(size > remaining()) {
+			stream_.setstate(std::ios_base::failbit);
+			return false;
+		}
+		std::memcpy(dst, gptr(), size);
+		setg(eback(), gptr()+size, egptr());
+		return true;
+	}
+	template<typename T> bool read(T &t) { return read(&t, sizeof(T)); }
+	template<typename T> bool readArray(T *t, std::size_t num) { return read(t, sizeof(T)*num); }
+	template<typename T> bool readLE(T &t) {
+		if(!read(t)) return false;
+		t = byteorder::little(t);
+		return true;
+	}
+	template<typename T> bool readArrayLE(T *t, std::size_t num) {
+		if(!readArray(t, num)) return false;
+		if(!byteorder::is_little_endian) {
+			std::transform(t, t+num, t, byteorder::little<T>);
+		}
+		return true;
+	}
+	bool skip(std::size_t size) { return seek(tell()+size); }
+	bool seek(std::size_t pos) {
+		if(pos > size()) {
+			stream_.setstate(std::ios_base::failbit);
+			return false;
+		}
+		setg(eback(), eback()+pos, egptr());
+		return true;
+	}
+
+	const char* data() const { return eback(); }
+	const char* current() const { return gptr(); }
+	std::size_t tell() const { return gptr()-eback(); }
+	std::size_t size() const { return egptr()-eback(); }
+	std::size_t remaining() const { return egptr()-gptr(); }
+	bool good() const { return !stream_.fail(); }
+	// format version of the data being read, for decoders that support older layouts
+	void setVersion(uint32_t version) { version_ = version; }
+	uint32_t getVersion() const { return version_; }
+
+	std::istream& stream() { return stream_; }
+private:
+	std::istream stream_;
+	uint32_t version_=0;
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+		off_type base = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? off_type(tell()) : off_type(size());
+		return seekpos(base+off, which);
+	}
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+		if(!(which & std::ios_base::in) || pos < 0 || std::size_t(pos) > size()) {
+			return pos_type(off_type(-1));
+		}
+		setg(eback(), eback()+off_type(pos), egptr());
+		return pos;
+	}
+};
+
+// reads everything from the current position to the end of a seekable stream
+inline std::vector<char> readRemaining(std::istream &stream)
+{
+	std::vector<char> ret;
+	auto begin_pos = stream.tellg();
+	if(begin_pos < 0 || !stream.seekg(0, std::ios_base::end)) {
+		stream.clear();
+		ret.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		return ret;
+	}
+	auto end_pos = stream.tellg();
+	stream.seekg(begin_pos);
+	ret.resize(end_pos-begin_pos);
+	stream.read(ret.data(), ret.size());
+	ret.resize(stream.gcount());
+	return ret;
+}
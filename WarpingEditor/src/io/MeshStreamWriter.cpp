@@ -0,0 +1,259 @@
+#include "MeshStreamWriter.h"
+#include "BinaryMesh.h"
+#include "ofLog.h"
+#include <iomanip>
+#include <numeric>
+#include <algorithm>
+
+namespace {
+const int PLY_COUNT_WIDTH = 20;
+const std::size_t COPY_BUFFER_SIZE = 1<<20;
+}
+
+bool MeshStreamWriter::open(const std::filesystem::path &filepath)
+{
+	close();
+	format_ = binary_mesh::isBinaryMeshPath(filepath) ? BINARY : PLY;
+	file_.open(ofToDataPath(filepath, true), std::ios::binary|std::ios::trunc);
+	if(!file_) {
+		ofLogError("MeshStreamWriter") << "failed to open file: " << filepath;
+		return false;
+	}
+	num_vertices_ = num_indices_ = 0;
+	is_header_written_ = false;
+	is_failed_ = false;
+	is_open_ = true;
+	return true;
+}
+
+void MeshStreamWriter::append(const ofMesh &mesh)
+{
+	if(!is_open_) {
+		return;
+	}
+	if(!is_header_written_) {
+		// attributes of the first mesh decide the layout of the whole file
+		has_texcoords_ = mesh.getNumTexCoords() == mesh.getNumVertices();
+		has_colors_ = mesh.getNumColors() == mesh.getNumVertices();
+		if(!writeHeader()) {
+			return;
+		}
+	}
+	auto num_vertices = mesh.getNumVertices();
+	auto vertex_offset = num_vertices_;
+	bool has_texcoords = mesh.getNumTexCoords() == num_vertices;
+	bool has_colors = mesh.getNumColors() == num_vertices;
+	std::vector<ofIndexType> indices = mesh.getIndices();
+	if(indices.empty() && mesh.getMode() == OF_PRIMITIVE_TRIANGLES) {
+		indices.resize(num_vertices);
+		std::iota(begin(indices), end(indices), 0);
+	}
+	// a trailing incomplete triangle is dropped by every format, so it is not counted either
+	indices.resize(indices.size() - indices.size()%3);
+	switch(format_) {
+		case PLY:
+			for(std::size_t i = 0; i < num_vertices; ++i) {
+				auto &&v = mesh.getVertex(i);
+				file_ << v.x << " " << v.y << " " << v.z;
+				if(has_colors_) {
+					ofColor c = has_colors ? ofColor(mesh.getColor(i)) : ofColor::white;
+					file_ << " " << (int)c.r << " " << (int)c.g << " " << (int)c.b << " " << (int)c.a;
+				}
+				if(has_texcoords_) {
+					auto t = has_texcoords ? mesh.getTexCoord(i) : glm::vec2(0,0);
+					file_ << " " << t.x << " " << t.y;
+				}
+				file_ << "\n";
+			}
+			for(std::size_t i = 0; i+2 < indices.size(); i += 3) {
+				if(std::fprintf(indices_, "3 %llu %llu %llu\n",
+								(unsigned long long)(indices[i]+vertex_offset),
+								(unsigned long long)(indices[i+1]+vertex_offset),
+								(unsigned long long)(indices[i+2]+vertex_offset)) < 0) {
+					is_failed_ = true;
+				}
+			}
+			break;
+		case BINARY: {
+			file_.write(reinterpret_cast<const char*>(mesh.getVerticesPointer()), num_vertices*sizeof(glm::vec3));
+			if(has_texcoords_) {
+				if(has_texcoords) {
+					writeSpool(mesh.getTexCoordsPointer(), sizeof(glm::vec2), num_vertices, texcoords_);
+				}
+				else {
+					std::vector<glm::vec2> t(num_vertices, {0,0});
+					writeSpool(t.data(), sizeof(glm::vec2), t.size(), texcoords_);
+				}
+			}
+			if(has_colors_) {
+				if(has_colors) {
+					writeSpool(mesh.getColorsPointer(), sizeof(ofFloatColor), num_vertices, colors_);
+				}
+				else {
+					std::vector<ofFloatColor> c(num_vertices, ofFloatColor::white);
+					writeSpool(c.data(), sizeof(ofFloatColor), c.size(), colors_);
+				}
+			}
+			std::vector<std::uint32_t> i32(indices.size());
+			std::transform(begin(indices), end(indices), begin(i32), [vertex_offset](ofIndexType i) {
+				return static_cast<std::uint32_t>(i + vertex_offset);
+			});
+			writeSpool(i32.data(), sizeof(std::uint32_t), i32.size(), indices_);
+		}	break;
+	}
+	num_vertices_ += num_vertices;
+	num_indices_ += indices.size();
+}
+
+bool MeshStreamWriter::close()
+{
+	if(!is_open_) {
+		return false;
+	}
+	if(!is_header_written_ && !writeHeader()) {
+		return false;
+	}
+	switch(format_) {
+		case PLY:
+			appendSpool(indices_);
+			patchHeader();
+			break;
+		case BINARY: {
+			auto header = binary_mesh::makeHeader(num_vertices_, num_indices_,
+												  (has_texcoords_ ? binary_mesh::HAS_TEXCOORDS : 0)
+												  | (has_colors_ ? binary_mesh::HAS_COLORS : 0));
+			auto padTo = [this](std::uint64_t offset) {
+				static const char zero[binary_mesh::ALIGNMENT] = {};
+				file_.write(zero, offset - static_cast<std::uint64_t>(file_.tellp()));
+			};
+			if(has_texcoords_) {
+				padTo(header.texcoords_offset);
+				appendSpool(texcoords_);
+			}
+			if(has_colors_) {
+				padTo(header.colors_offset);
+				appendSpool(colors_);
+			}
+			padTo(header.indices_offset);
+			appendSpool(indices_);
+			file_.seekp(0, std::ios_base::beg);
+			file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		}	break;
+	}
+	closeSpool(texcoords_);
+	closeSpool(colors_);
+	closeSpool(indices_);
+	bool ret = !is_failed_ && file_.good();
+	// flushing on close can fail too
+	file_.close();
+	ret = ret && !file_.fail();
+	is_open_ = false;
+	return ret;
+}
+
+bool MeshStreamWriter::writeHeader()
+{
+	switch(format_) {
+		case PLY:
+			file_ << "ply\n";
+			file_ << "format ascii 1.0\n";
+			file_ << "element vertex ";
+			vertex_count_pos_ = file_.tellp();
+			file_ << std::setw(PLY_COUNT_WIDTH) << std::setfill('0') << 0 << std::setfill(' ') << "\n";
+			file_ << "property float x\n";
+			file_ << "property float y\n";
+			file_ << "property float z\n";
+			if(has_colors_) {
+				file_ << "property uchar red\n";
+				file_ << "property uchar green\n";
+				file_ << "property uchar blue\n";
+				file_ << "property uchar alpha\n";
+			}
+			if(has_texcoords_) {
+				file_ << "property float u\n";
+				file_ << "property float v\n";
+			}
+			file_ << "element face ";
+			face_count_pos_ = file_.tellp();
+			file_ << std::setw(PLY_COUNT_WIDTH) << std::setfill('0') << 0 << std::setfill(' ') << "\n";
+			file_ << "property list uchar int vertex_indices\n";
+			file_ << "end_header\n";
+			indices_ = openSpool();
+			break;
+		case BINARY: {
+			binary_mesh::Header placeholder{};
+			file_.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+			static const char zero[binary_mesh::ALIGNMENT] = {};
+			file_.write(zero, binary_mesh::align(sizeof(placeholder)) - sizeof(placeholder));
+			if(has_texcoords_) texcoords_ = openSpool();
+			if(has_colors_) colors_ = openSpool();
+			indices_ = openSpool();
+		}	break;
+	}
+	if(!indices_ || (has_texcoords_ && !texcoords_) || (has_colors_ && !colors_)) {
+		closeSpool(texcoords_);
+		closeSpool(colors_);
+		closeSpool(indices_);
+		file_.close();
+		is_open_ = false;
+		return false;
+	}
+	is_header_written_ = true;
+	return true;
+}
+
+void MeshStreamWriter::patchHeader()
+{
+	auto end_pos = file_.tellp();
+	file_.seekp(vertex_count_pos_, std::ios_base::beg);
+	file_ << std::setw(PLY_COUNT_WIDTH) << std::setfill('0') << num_vertices_;
+	file_.seekp(face_count_pos_, std::ios_base::beg);
+	file_ << std::setw(PLY_COUNT_WIDTH) << std::setfill('0') << num_indices_/3;
+	file_ << std::setfill(' ');
+	file_.seekp(end_pos, std::ios_base::beg);
+}
+
+std::FILE* MeshStreamWriter::openSpool()
+{
+	auto ret = std::tmpfile();
+	if(!ret) {
+		ofLogError("MeshStreamWriter") << "failed to create a temporary file";
+	}
+	return ret;
+}
+
+void MeshStreamWriter::closeSpool(std::FILE *&spool)
+{
+	if(spool) {
+		std::fclose(spool);
+		spool = nullptr;
+	}
+}
+
+void MeshStreamWriter::writeSpool(const void *data, std::size_t size, std::size_t count, std::FILE *spool)
+{
+	if(std::fwrite(data, size, count, spool) != count || std::ferror(spool)) {
+		is_failed_ = true;
+	}
+}
+
+void MeshStreamWriter::appendSpool(std::FILE *spool)
+{
+	if(!spool) {
+		return;
+	}
+	// flushes what is still buffered; a write error may show up only here
+	if(std::fflush(spool) != 0 || std::ferror(spool)) {
+		is_failed_ = true;
+		return;
+	}
+	std::rewind(spool);
+	std::vector<char> buffer(COPY_BUFFER_SIZE);
+	std::size_t size;
+	while((size = std::fread(buffer.data(), 1, buffer.size(), spool)) > 0) {
+		file_.write(buffer.data(), size);
+	}
+	if(std::ferror(spool) || !file_) {
+		is_failed_ = true;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+#include "ofMesh.h"
+
+// writes meshes one by one into a single file without holding the whole result in memory.
+// the element counts in the header are patched on close.
+// the format is chosen by extension: binary_mesh for .bmsh, ascii PLY (as ofMesh::save) otherwise.
+class MeshStreamWriter
+{
+public:
+	~MeshStreamWriter() { close(); }
+	bool open(const std::filesystem::path &filepath);
+	void append(const ofMesh &mesh);
+	bool close();
+	
+	std::size_t getNumVertices() const { return num_vertices_; }
+	std::size_t getNumIndices() const { return num_indices_; }
+private:
+	enum Format {
+		PLY,
+		BINARY
+	} format_;
+	std::ofstream file_;
+	// sections that have to come after all the vertices are spooled here until close
+	std::FILE *texcoords_=nullptr, *colors_=nullptr, *indices_=nullptr;
+	bool is_open_=false;
+	bool is_header_written_=false;
+	// set by any short or failed write; close() reports it
+	bool is_failed_=false;
+	bool has_texcoords_=false, has_colors_=false;
+	std::uint64_t num_vertices_=0, num_indices_=0;
+	std::streampos vertex_count_pos_, face_count_pos_;
+	
+	bool writeHeader();
+	void patchHeader();
+	void writeSpool(const void *data, std::size_t size, std::size_t count, std::FILE *spool);
+	void appendSpool(std::FILE *spool);
+	std::FILE* openSpool();
+	void closeSpool(std::FILE *&spool);
+};
@@ -1,101 +1,180 @@
 #include "SaveData.h"
 #include "ofxBlendScreen.h"
+#include "MappedFile.h"
 
 namespace {
 template<typename T>
-void writeTo(std::ostream& os, const T& t) {
-	os.write(reinterpret_cast<const char*>(&t), sizeof(T));
+void writeTo(ByteWriter &writer, const T &t) {
+	writer.write(t);
 }
 template<typename T>
-void readFrom(std::istream& is, T& t) {
-	is.read(reinterpret_cast<char*>(&t), sizeof(T));
+bool readFrom(ByteReader &reader, T &t) {
+	return reader.read(t);
 }
 template<>
-void writeTo<glm::vec3>(std::ostream &os, const glm::vec3 &t) {
-	writeTo(os, t[0]);
-	writeTo(os, t[1]);
-	writeTo(os, t[2]);
+void writeTo<glm::vec3>(ByteWriter &writer, const glm::vec3 &t) {
+	writer.writeArrayLE(&t[0], 3);
 }
 template<>
-void readFrom<glm::vec3>(std::istream &is, glm::vec3 &t) {
-	readFrom(is, t[0]);
-	readFrom(is, t[1]);
-	readFrom(is, t[2]);
+bool readFrom<glm::vec3>(ByteReader &reader, glm::vec3 &t) {
+	return reader.readArrayLE(&t[0], 3);
 }
 template<>
-void writeTo<ofxBlendScreen::Shader::Params>(std::ostream &os, const ofxBlendScreen::Shader::Params &t) {
-	writeTo(os, t.gamma);
-	writeTo(os, t.luminance_control);
-	writeTo(os, t.blend_power);
-	writeTo(os, t.base_color);
+void writeTo<float>(ByteWriter &writer, const float &t) {
+	writer.writeLE(t);
 }
 template<>
-void readFrom<ofxBlendScreen::Shader::Params>(std::istream &is, ofxBlendScreen::Shader::Params &t) {
-	readFrom(is, t.gamma);
-	readFrom(is, t.luminance_control);
-	readFrom(is, t.blend_power);
-	readFrom(is, t.base_color);
+bool readFrom<float>(ByteReader &reader, float &t) {
+	return reader.readLE(t);
+}
+template<>
+void writeTo<ofxBlendScreen::Shader::Params>(ByteWriter &writer, const ofxBlendScreen::Shader::Params &t) {
+	writeTo(writer, t.gamma);
+	writeTo(writer, t.luminance_control);
+	writeTo(writer, t.blend_power);
+	writeTo(writer, t.base_color);
+}
+template<>
+bool readFrom<ofxBlendScreen::Shader::Params>(ByteReader &reader, ofxBlendScreen::Shader::Params &t) {
+	return readFrom(reader, t.gamma)
+	&& readFrom(reader, t.luminance_control)
+	&& readFrom(reader, t.blend_power)
+	&& readFrom(reader, t.base_color);
+}
+
+// v1 wrote the version and chunk sizes as size_t, which is 8 bytes on every platform we have shipped.
+// v2 fixes them to little endian u32/u64 of the same widths, so both share the framing below:
+//   "maap" | u32 version | u32 reserved | { char[4] name | u64 size | data } ...
+bool readHeader(ByteReader &reader, uint32_t &version) {
+	char maap[4];
+	uint32_t reserved;
+	if(!reader.read(maap) || strncmp(maap, "maap", 4) != 0) {
+		ofLogError("SaveData") << "not a maap file";
+		return false;
+	}
+	if(!reader.readLE(version) || !reader.readLE(reserved)) {
+		ofLogError("SaveData") << "broken header";
+		return false;
+	}
+	if(version == 0 || version > SaveData::VERSION) {
+		ofLogError("SaveData") << "unsupported version: " << version;
+		return false;
+	}
+	return true;
+}
+// calls func with a reader limited to each chunk until it returns false
+void forEachChunk(ByteReader &reader, uint32_t version, std::function<bool(const std::string&, ByteReader&)> func) {
+	while(reader.remaining() > 0) {
+		char chunkname[4];
+		uint64_t chunksize;
+		if(!reader.read(chunkname) || !reader.readLE(chunksize)) {
+			break;
+		}
+		ByteReader chunk(reader.current(), std::min<uint64_t>(chunksize, reader.remaining()));
+		chunk.setVersion(version);
+		if(!func(std::string(chunkname, 4), chunk) || !reader.skip(chunksize)) {
+			break;
+		}
+	}
 }
 }
 template<>
-void SaveData::pack<ofxBlendScreen::Shader::Params>(std::ostream &stream, const ofxBlendScreen::Shader::Params &t)
+void SaveData::pack<ofxBlendScreen::Shader::Params>(ByteWriter &writer, const ofxBlendScreen::Shader::Params &t)
 {
-	writeTo(stream, t);
+	writeTo(writer, t);
 }
 template<>
-void SaveData::unpack<ofxBlendScreen::Shader::Params>(std::istream &stream, ofxBlendScreen::Shader::Params &t)
+void SaveData::unpack<ofxBlendScreen::Shader::Params>(ByteReader &reader, ofxBlendScreen::Shader::Params &t)
 {
-	readFrom(stream, t);
+	readFrom(reader, t);
 }
 
+// the whole file is built in memory and written at once
 void SaveData::pack(std::ostream &stream) const
+{
+	ByteWriter writer;
+	pack(writer);
+	stream.write(writer.data(), writer.size());
+}
+
+void SaveData::unpack(std::istream &stream)
+{
+	auto buffer = readRemaining(stream);
+	ByteReader reader(buffer.data(), buffer.size());
+	unpack(reader);
+}
+
+void SaveData::pack(ByteWriter &writer) const
 {
 	// header
-	stream << "maap";
-	writeTo<std::size_t>(stream, 1);	// version number
+	writer.writeArray("maap", 4);
+	writer.writeLE<uint32_t>(VERSION);
+	writer.writeLE<uint32_t>(0);	// reserved
 
 	for(auto &&d : data_) {
-		stream << d.first;
-		auto pos_to_write_chunksize = stream.tellp();
-		writeTo<std::size_t>(stream, 0);	// placeholder for chunksize
-		auto begin_chunksize = stream.tellp();
-		d.second->pack(stream);
-		auto end_pos = stream.tellp();
-		auto chunksize = end_pos - begin_chunksize;
-		stream.seekp(pos_to_write_chunksize, std::ios_base::beg);
-		writeTo(stream, chunksize);
-		stream.seekp(end_pos, std::ios_base::beg);
+		writer.writeArray(d.first.c_str(), 4);
+		auto pos_to_write_chunksize = writer.tell();
+		writer.writeLE<uint64_t>(0);	// placeholder for chunksize
+		auto begin_chunk = writer.tell();
+		d.second->pack(writer);
+		writer.writeAtLE<uint64_t>(pos_to_write_chunksize, writer.tell() - begin_chunk);
 	}
 }
 
-void SaveData::unpack(std::istream &stream)
+void SaveData::unpack(ByteReader &reader)
 {
-	// header
-	char maap[4];
-	readFrom(stream, maap);
-	assert(strncmp(maap, "maap", 4) == 0);
-	std::size_t version;
-	readFrom(stream, version);
-	
-	while(stream.good()) {
-		char chunkname[4];
-		std::size_t chunksize;
-		readFrom(stream, chunkname);
-		readFrom(stream, chunksize);
-		if(stream.eof() || stream.fail()) {
-			break;
-		}
-		auto next_pos = std::size_t(stream.tellg()) + chunksize;
-		auto found = find_if(begin(data_), end(data_), [chunkname](const std::pair<std::string, std::shared_ptr<HasSaveData>> &p) {
-			return strncmp(chunkname, p.first.c_str(), 4) == 0;
+	uint32_t version;
+	if(!readHeader(reader, version)) {
+		return;
+	}
+	forEachChunk(reader, version, [this](const std::string &name, ByteReader &chunk) {
+		auto found = find_if(begin(data_), end(data_), [&name](const std::pair<std::string, std::shared_ptr<HasSaveData>> &p) {
+			return strncmp(name.c_str(), p.first.c_str(), 4) == 0;
 		});
 		if(found == end(data_)) {
-			ofLogWarning("SaveData") << "skipped unhandled chunk: " << chunkname;
+			ofLogWarning("SaveData") << "skipped unhandled chunk: " << name;
 		}
 		else {
-			found->second->unpack(stream);
+			found->second->unpack(chunk);
 		}
-		stream.seekg(next_pos, std::ios_base::beg);
+		return true;
+	});
+}
+
+std::unique_ptr<ByteReader> SaveData::findChunk(ByteReader &reader, const std::string &chunk_name)
+{
+	std::unique_ptr<ByteReader> ret;
+	uint32_t version;
+	if(!readHeader(reader, version)) {
+		return ret;
 	}
+	forEachChunk(reader, version, [&](const std::string &name, ByteReader &chunk) {
+		if(strncmp(name.c_str(), chunk_name.c_str(), 4) != 0) {
+			return true;
+		}
+		ret = std::make_unique<ByteReader>(chunk.current(), chunk.remaining());
+		ret->setVersion(version);
+		return false;
+	});
+	return ret;
 }
 
+bool SaveData::withFileReader(const std::filesystem::path &filepath, std::function<void(ByteReader&)> func)
+{
+	MappedFile mapped(filepath);
+	if(mapped.isOpen()) {
+		ByteReader reader(reinterpret_cast<const char*>(mapped.data()), mapped.size());
+		func(reader);
+		return true;
+	}
+	ofFile file(filepath, ofFile::ReadOnly);
+	if(!file.exists() || !file.is_open()) {
+		ofLogError("SaveData") << "failed to open: " << filepath;
+		return false;
+	}
+	auto buffer = readRemaining(file);
+	file.close();
+	ByteReader reader(buffer.data(), buffer.size());
+	func(reader);
+	return true;
+}
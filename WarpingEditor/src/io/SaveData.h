@@ -5,22 +5,31 @@
 #include <filesystem>
 #include "ofFileUtils.h"
 #include "ofxBlendScreen.h"
+#include "ByteBuffer.h"
+#include <functional>
 
 class HasSaveData
 {
 public:
 	virtual void pack(std::ostream &stream) const {}
 	virtual void unpack(std::istream &stream) {}
+	// buffer versions fall back to the stream ones; override them to skip the stream layer
+	virtual void pack(ByteWriter &writer) const { pack(writer.stream()); }
+	virtual void unpack(ByteReader &reader) { unpack(reader.stream()); }
 };
 
 template<typename Arg>
 class HasSaveDataWithArg : public HasSaveData
 {
 public:
-	void pack(std::ostream &stream) const { pack(stream, pack_arg_); }
-	void unpack(std::istream &stream) { unpack(stream, unpack_arg_); }
+	void pack(std::ostream &stream) const override { pack(stream, pack_arg_); }
+	void unpack(std::istream &stream) override { unpack(stream, unpack_arg_); }
+	void pack(ByteWriter &writer) const override { pack(writer, pack_arg_); }
+	void unpack(ByteReader &reader) override { unpack(reader, unpack_arg_); }
 	virtual void pack(std::ostream &stream, const Arg &arg) const {}
 	virtual void unpack(std::istream &stream, const Arg &arg) {}
+	virtual void pack(ByteWriter &writer, const Arg &arg) const { pack(writer.stream(), arg); }
+	virtual void unpack(ByteReader &reader, const Arg &arg) { unpack(reader.stream(), arg); }
 	void setPackArg(const Arg &arg) { pack_arg_ = arg; }
 	void setUnpackArg(const Arg &arg) { unpack_arg_ = arg; }
 protected:
@@ -30,6 +39,8 @@ protected:
 class SaveData
 {
 public:
+	// 2: fixed width little endian fields and a table of contents in each DataContainer
+	static const uint32_t VERSION = 2;
 	void append(char chunk_name[4], std::shared_ptr<HasSaveData> data) {
 		data_.push_back({std::string(chunk_name), data});
 	}
@@ -42,18 +53,24 @@ public:
 		file.close();
 	}
 	void load(const std::filesystem::path &filepath) {
-		ofFile file(filepath, ofFile::ReadOnly);
-		unpack(file);
-		file.close();
+		withFileReader(filepath, [this](ByteReader &reader) { unpack(reader); });
 	}
 	void pack(std::ostream &stream) const;
 	void unpack(std::istream &stream);
+	void pack(ByteWriter &writer) const;
+	void unpack(ByteReader &reader);
+	// locates a chunk in packed data without decoding the others.
+	// the returned reader shares the buffer of the given one. nullptr if not found.
+	static std::unique_ptr<ByteReader> findChunk(ByteReader &reader, const std::string &chunk_name);
+	// passes the whole file to func, decoded directly from a memory mapping.
+	// falls back to reading into memory if the file can't be mapped. returns false if it can't be read at all.
+	static bool withFileReader(const std::filesystem::path &filepath, std::function<void(ByteReader&)> func);
 	
-	template<typename T> static void pack(std::ostream &stream, const T &t);
-	template<typename T> static void unpack(std::istream &stream, T &t);
+	template<typename T> static void pack(ByteWriter &writer, const T &t);
+	template<typename T> static void unpack(ByteReader &reader, T &t);
 private:
 	std::vector<std::pair<std::string, std::shared_ptr<HasSaveData>>> data_;
 };
 
-template<> void SaveData::pack<ofxBlendScreen::Shader::Params>(std::ostream &stream, const ofxBlendScreen::Shader::Params &t);
-template<> void SaveData::unpack<ofxBlendScreen::Shader::Params>(std::istream &stream, ofxBlendScreen::Shader::Params &t);
+template<> void SaveData::pack<ofxBlendScreen::Shader::Params>(ByteWriter &writer, const ofxBlendScreen::Shader::Params &t);
+template<> void SaveData::unpack<ofxBlendScreen::Shader::Params>(ByteReader &reader, ofxBlendScreen::Shader::Params &t);
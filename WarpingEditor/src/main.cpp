@@ -1,9 +1,25 @@
 #include "ofMain.h"
 #include "ofApp.h"
 #include "ofAppGLFWWindow.h"
+#include "Benchmark.h"
+#include "CpuRenderer.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char *argv[]){
+	// WarpingEditor --benchmark [project folders...]
+	// WarpingEditor --render project_folder source_image [output_folder]
+	std::vector<std::string> args(argv+1, argv+argc);
+	auto benchmark = std::find(begin(args), end(args), "--benchmark");
+	if(benchmark != end(args)) {
+		ofInit();
+		return bench::run(std::vector<std::string>(std::next(benchmark), end(args)));
+	}
+	auto render_flag = std::find(begin(args), end(args), "--render");
+	if(render_flag != end(args)) {
+		ofInit();
+		return render::run(std::vector<std::string>(std::next(render_flag), end(args)));
+	}
+
 	ofGLFWWindowSettings settings;
 
 	settings.setGLVersion(4,1);
@@ -3,6 +3,8 @@
 #include "GuiFunc.h"
 #include "Icon.h"
 #include "ImGuiFileDialog.h"
+#include "Profiler.h"
+#include "LookupTable.h"
 
 namespace {
 template<typename T>
@@ -22,6 +24,11 @@ std::shared_ptr<ImageSource> buildTextureSource(const ProjectFolder &proj) {
 				return ret;
 			}
 			break;
+		case ProjectFolder::Texture::SEQUENCE:
+			if(ret->loadSequence(proj.getTextureSequenceFolder(), proj.getTextureSequenceFps())) {
+				return ret;
+			}
+			break;
 	}
 	return nullptr;
 }
@@ -86,9 +93,15 @@ void GuiApp::initUndo()
 
 //--------------------------------------------------------------
 void GuiApp::update(){
+	Profiler::shared().newFrame();
+	PROFILE_SCOPE("GuiApp::update");
 	if(texture_source_) {
+		{
+			PROFILE_SCOPE("ImageSource::update");
+			texture_source_->update();
+		}
+		// taken after update since the first frame may allocate the texture
 		auto tex = texture_source_->getTexture();
-		texture_source_->update();
 		if(texture_source_->isFrameNew()) {
 			warp_uv_->setTexture(tex);
 			warp_mesh_->setTexture(tex);
@@ -110,11 +123,13 @@ void GuiApp::update(){
 
 	auto editor = editor_[stateName(state_)];
 	if(editor) {
+		PROFILE_SCOPE("Editor::update");
 		editor->setRegion(ofGetCurrentViewport());
 		editor->update();
 	}
 	
 	if(!warp_uv_->isPreventMeshInterpolation() && !warp_mesh_->isPreventMeshInterpolation()) {
+		PROFILE_SCOPE("WarpingData::update");
 		warping_data_->update();
 	}
 	if(texture_source_) {
@@ -124,7 +139,11 @@ void GuiApp::update(){
 			glm::vec2 tex_scale = tex_data.textureTarget == GL_TEXTURE_RECTANGLE_ARB
 			? glm::vec2{1,1}
 			: glm::vec2{1/tex_data.tex_w, 1/tex_data.tex_h};
-			auto warped_mesh = warping_data_->getMesh(100, tex_scale);
+			auto &&warped_mesh = [&]() -> const ofVboMesh& {
+				PROFILE_SCOPE("WarpingData::getRetainedMesh");
+				return warping_data_->getRetainedMesh(100, tex_scale);
+			}();
+			PROFILE_SCOPE("fbo");
 			fbo_.begin();
 			ofClear(0);
 			tex.bind();
@@ -138,11 +157,14 @@ void GuiApp::update(){
 
 //--------------------------------------------------------------
 void GuiApp::draw(){
+	PROFILE_SCOPE("GuiApp::draw");
 	auto editor = editor_[stateName(state_)];
 	if(editor) {
+		PROFILE_SCOPE("Editor::draw");
 		editor->draw();
 	}
 	
+	PROFILE_SCOPE("ImGui");
 	gui_.begin();
 	using namespace ImGui;
 	Shortcut sc_save{[&]{save();}, 'S'};
@@ -214,6 +236,20 @@ void GuiApp::draw(){
 				}
 				ImGui::EndMenu();
 			}
+			if(BeginMenu("Image Sequence")) {
+				if(MenuItem("Load from folder...")) {
+					ImGuiFileDialog::Instance()->OpenModal("ChooseSequenceDlgKey", "Choose Image Sequence Folder", nullptr, ofFilePath::addTrailingSlash(proj_.getAbsolute().string()));
+				}
+				float fps = proj_.getTextureSequenceFps();
+				if(DragFloat("fps", &fps, 0.1f, 0.1f, 240, "%.2f")) {
+					proj_.setTextureSequenceFps(fps);
+				}
+				// rebuilding restarts the workers, so wait until the drag ends
+				if(IsItemDeactivatedAfterEdit() && proj_.getTextureType() == ProjectFolder::Texture::SEQUENCE) {
+					texture_source_ = buildTextureSource(proj_);
+				}
+				ImGui::EndMenu();
+			}
 			if(BeginMenu("NDI")) {
 				auto source = ndi_finder_.getSources();
 				for(auto &&s : source) {
@@ -237,6 +273,9 @@ void GuiApp::draw(){
 			}
 			ImGui::EndMenu();
 		}
+		if(saver_.isBusy()) {
+			TextDisabled("%s", "saving...");
+		}
 		EndMainMenuBar();
 	}
 
@@ -284,6 +323,15 @@ void GuiApp::draw(){
 			}
 			TreePop();
 		}
+		if(TreeNodeEx("lookup table", ImGuiTreeNodeFlags_DefaultOpen)) {
+			auto param = proj_.getExportLookupTableParam();
+			if(Checkbox("enabled", &param.enabled)
+			   || EditText("uv_filename", param.uv_filename)
+			   || EditText("blend_filename", param.blend_filename)) {
+				proj_.setExportLookupTableParam(param);
+			}
+			TreePop();
+		}
 		if(Button("export")) {
 			sc_export();
 			CloseCurrentPopup();
@@ -307,11 +355,21 @@ void GuiApp::draw(){
 			std::string filePath = ImGuiFileDialog::Instance()->GetCurrentPath();
 			proj_.WorkFolder::setRelative(filePathName);
 			save();
+			// setup reads project.json back from the new folder
+			saver_.wait();
 			proj_.setup();
 			updateRecent(proj_);
 		}
 		ImGuiFileDialog::Instance()->Close();
 	}
+	if(ImGuiFileDialog::Instance()->Display("ChooseSequenceDlgKey")) {
+		if (ImGuiFileDialog::Instance()->IsOk() == true) {
+			std::string filePathName = ImGuiFileDialog::Instance()->GetFilePathName();
+			proj_.setTextureSourceSequence(filePathName, proj_.getTextureSequenceFps());
+			texture_source_ = buildTextureSource(proj_);
+		}
+		ImGuiFileDialog::Instance()->Close();
+	}
 	if(ImGuiFileDialog::Instance()->Display("ChooseFileDlgKey")) {
 		if (ImGuiFileDialog::Instance()->IsOk() == true) {
 			std::string filePathName = ImGuiFileDialog::Instance()->GetFilePathName();
@@ -343,6 +401,24 @@ void GuiApp::draw(){
 			}
 			TreePop();
 		}
+		if(TreeNode("save")) {
+			saver_.gui();
+			TreePop();
+		}
+		if(TreeNode("tessellation")) {
+			float tolerance = warping_data_->getTessellationTolerance();
+			if(DragFloat("tolerance(px)", &tolerance, 0.01f, 0, 10)) {
+				warping_data_->setTessellationTolerance(tolerance);
+			}
+			if(IsItemHovered()) {
+				SetTooltip("0: uniform by resample interval");
+			}
+			TreePop();
+		}
+		if(TreeNode("profiler")) {
+			Profiler::shared().gui();
+			TreePop();
+		}
 	}
 	End();
 	if(Begin("ResultWindow")) {
@@ -473,6 +549,19 @@ void GuiApp::exportMesh(const ProjectFolder &proj) const
 		auto param = proj_.getExportBlendShaderParam();
 		ofSavePrettyJson(ofFilePath::join(folder, param.filename), blending_data_->getShader()->getParams());
 	}
+	{
+		auto param = proj_.getExportLookupTableParam();
+		if(param.enabled) {
+			// uv is always normalized here; remap textures have no notion of arb
+			glm::ivec2 bridge_size{fbo_.getWidth(), fbo_.getHeight()};
+			auto tex = texture_source_->getTexture();
+			glm::vec2 coord_size = tex.isAllocated() ? glm::vec2{1/tex.getWidth(), 1/tex.getHeight()} : glm::vec2{1,1};
+			auto uv_map = render::makeUVMap(*warping_data_, coord_size, bridge_size, proj_.getExportWarpParam().max_mesh_size);
+			uv_map.save(ofFilePath::join(folder, param.uv_filename));
+			auto blend_map = render::makeBlendMap(*blending_data_, blending_data_->getShader()->getParams(), bridge_size, proj_.getExportBlendParam().max_mesh_size);
+			blend_map.save(ofFilePath::join(folder, param.blend_filename));
+		}
+	}
 }
 
 
@@ -530,45 +619,44 @@ void GuiApp::save(bool do_backup) const
 	proj_.setBlendParams(blending_data_->getShader()->getParams());
 	
 	proj_.setBridgeResolution({fbo_.getWidth(), fbo_.getHeight()});
+	proj_.setTessellationTolerance(warping_data_->getTessellationTolerance());
 	
-	proj_.save();
-
-	auto filepath = proj_.getDataFilePath();
-	saveDataFile(filepath);
-
-	if(do_backup && proj_.isBackupEnabled()) {
-		auto backup_path = proj_.getBackupFilePath();
-		ofDirectory folder(ofFilePath::getEnclosingDirectory(backup_path));
-		if(!folder.exists()) {
-			folder.create();
-		}
-		ofFile(filepath).copyTo(backup_path);
-		int num = proj_.getBackupNumLimit();
-		if(num > 0) {
-			folder.allowExt(ofFilePath::getFileExt(backup_path));
-			folder.sortByDate();
-			for(int i = 0; i < folder.size() - num; ++i) {
-				folder.getFile(i).remove();
-			}
-		}
+	// only the snapshot is taken here. writing, backup and pruning happen on the saver's thread.
+	AsyncSaver::Request request;
+	request.files.push_back({proj_.getProjFilePath(), {}});
+	auto json = proj_.toJsonString();
+	request.files.back().data.assign(begin(json), end(json));
+	{
+		ByteWriter writer;
+		packDataFile(writer);
+		request.files.push_back({proj_.getDataFilePath(), writer.release()});
+	}
+	request.do_backup = do_backup && proj_.isBackupEnabled();
+	if(request.do_backup) {
+		request.backup_file_index = 1;
+		request.backup_path = proj_.getBackupFilePath();
+		request.backup_limit = proj_.getBackupNumLimit();
 	}
+	saver_.save(std::move(request));
 }
 
 void GuiApp::saveDataFile(const std::filesystem::path &filepath) const
 {
+	ByteWriter writer;
+	packDataFile(writer);
 	ofFile file(filepath, ofFile::WriteOnly);
-	packDataFile(file);
+	file.write(writer.data(), writer.size());
 	file.close();
 }
 
 void GuiApp::loadDataFile(const std::filesystem::path &filepath)
 {
-	ofFile file(filepath, ofFile::ReadOnly);
-	unpackDataFile(file);
-	file.close();
+	SaveData::withFileReader(filepath, [this](ByteReader &reader) {
+		unpackDataFile(reader);
+	});
 }
 
-void GuiApp::packDataFile(std::ostream &stream) const
+void GuiApp::packDataFile(ByteWriter &writer) const
 {
 	SaveData saver;
 	{
@@ -581,10 +669,10 @@ void GuiApp::packDataFile(std::ostream &stream) const
 		blending_data_->setPackArg({1/tex_size.x, 1/tex_size.y});
 		saver.append((char *)"blnd", blending_data_);
 	}
-	saver.pack(stream);
+	saver.pack(writer);
 }
 
-void GuiApp::unpackDataFile(std::istream &stream)
+void GuiApp::unpackDataFile(ByteReader &reader)
 {
 	SaveData loader;
 	{
@@ -597,12 +685,14 @@ void GuiApp::unpackDataFile(std::istream &stream)
 		blending_data_->setUnpackArg(tex_size);
 		loader.append((char *)"blnd", blending_data_);
 	}
-	loader.unpack(stream);
+	loader.unpack(reader);
 }
 
 
 void GuiApp::openProject(const std::filesystem::path &proj_path)
 {
+	// the project may be the one being saved
+	saver_.wait();
 	proj_.WorkFolder::setRelative(proj_path);
 	proj_.setup();
 
@@ -641,6 +731,7 @@ void GuiApp::openProject(const std::filesystem::path &proj_path)
 		blend_editor_->setGridData(proj_.getBlendGridData());
 	}
 	blending_data_->getShader()->getParams() = proj_.getBlendParams();
+	blending_data_->setModified();
 	
 	updateRecent(proj_);
 
@@ -654,6 +745,7 @@ void GuiApp::openProject(const std::filesystem::path &proj_path)
 
 	auto filepath = proj_.getDataFilePath();
 	loadDataFile(filepath);
+	warping_data_->setTessellationTolerance(proj_.getTessellationTolerance());
 
 	auto bridge_res = proj_.getBridgeResolution();
 	fbo_.allocate(bridge_res.x, bridge_res.y, GL_RGB);
@@ -717,6 +809,7 @@ void ResultView::setup()
 
 void ResultView::draw()
 {
+	PROFILE_SCOPE("ResultView::draw");
 	if(editor_) {
 		if(is_scale_to_viewport_) {
 			auto editor_size = editor_->getWorkAreaSize();
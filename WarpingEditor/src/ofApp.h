@@ -11,6 +11,7 @@
 #include "ProjectFolder.h"
 #include "Undo.h"
 #include "SaveData.h"
+#include "AsyncSaver.h"
 
 class ResultView;
 
@@ -28,8 +29,8 @@ public:
 	
 	void saveDataFile(const std::filesystem::path &filepath) const;
 	void loadDataFile(const std::filesystem::path &filepath);
-	void packDataFile(std::ostream &stream) const;
-	void unpackDataFile(std::istream &stream);
+	void packDataFile(ByteWriter &writer) const;
+	void unpackDataFile(ByteReader &reader);
 	
 	void keyPressed(int key) override;
 	void mouseReleased(int x, int y, int button) override;
@@ -75,6 +76,7 @@ private:
 	ofxNDIFinder ndi_finder_;
 	
 	mutable ProjectFolder proj_;
+	mutable AsyncSaver saver_;
 	
 	Undo undo_;
 	void initUndo();
@@ -0,0 +1,162 @@
+#include "CpuRenderer.h"
+#include "Rasterizer.h"
+#include "ProjectFolder.h"
+#include "SaveData.h"
+#include "ofImage.h"
+#include "ofLog.h"
+#include <chrono>
+#include <iostream>
+
+namespace {
+// same as the default alpha blending of the GL renderer, applied to all four channels
+void blendOver(float *dst, const glm::vec4 &src)
+{
+	float a = src.a;
+	for(int i = 0; i < 4; ++i) {
+		dst[i] = src[i]*a + dst[i]*(1-a);
+	}
+}
+void fill(ofFloatPixels &pixels, const glm::vec4 &color)
+{
+	float *p = pixels.getData();
+	std::size_t num_pixels = pixels.getWidth()*pixels.getHeight();
+	for(std::size_t i = 0; i < num_pixels; ++i, p += 4) {
+		p[0] = color.r; p[1] = color.g; p[2] = color.b; p[3] = color.a;
+	}
+}
+bool savePixels(const ofFloatPixels &pixels, const std::filesystem::path &path)
+{
+	ofPixels converted = pixels;
+	if(!ofSaveImage(converted, path)) {
+		ofLogError("render") << "failed to save " << path;
+		return false;
+	}
+	return true;
+}
+}
+
+namespace render {
+float blendCurve(float ramp, float blend_power, float luminance_control)
+{
+	ramp = ofClamp(ramp, 0, 1);
+	return ramp < 0.5f
+	? luminance_control*std::pow(2*ramp, blend_power)
+	: 1-(1-luminance_control)*std::pow(2*(1-ramp), blend_power);
+}
+
+ofFloatPixels renderWarp(const ofFloatPixels &source, const WarpingData &data, const glm::ivec2 &bridge_size, float resample_interval)
+{
+	ofFloatPixels ret;
+	ret.allocate(bridge_size.x, bridge_size.y, OF_PIXELS_RGBA);
+	fill(ret, {0,0,0,0});
+	auto src = toRGBA(source);
+	glm::vec2 tex_scale{1.f/src.getWidth(), 1.f/src.getHeight()};
+	auto mesh = data.getMesh(resample_interval, tex_scale);
+	float *dst = ret.getData();
+	rasterize(mesh, bridge_size.x, bridge_size.y, {0,0}, [&](const Span &span) {
+		float *row = dst+(std::size_t(span.y)*bridge_size.x+span.x0)*4;
+		for(int i = 0; i < span.size; ++i) {
+			if(!span.mask[i]) continue;
+			glm::vec4 c = sampleBilinear(src, span.u[i], span.v[i]);
+			c *= glm::vec4(span.r[i], span.g[i], span.b[i], span.a[i]);
+			blendOver(row+i*4, c);
+		}
+	});
+	return ret;
+}
+
+std::vector<Output> renderOutputs(const ofFloatPixels &bridge, const BlendingData &data, const ofxBlendScreen::Shader::Params &params, float resample_interval)
+{
+	std::vector<Output> ret;
+	auto src = toRGBA(bridge);
+	glm::vec2 tex_scale{1.f/src.getWidth(), 1.f/src.getHeight()};
+	glm::vec3 gamma_inv = 1.f/glm::max(glm::vec3(params.gamma[0], params.gamma[1], params.gamma[2]), glm::vec3(1e-4f));
+	glm::vec3 base_color(params.base_color[0], params.base_color[1], params.base_color[2]);
+	for(auto &&d : data.getVisibleData()) {
+		auto &&outer = d.second->mesh->quad[0];
+		glm::vec2 min = outer[0], max = outer[0];
+		for(auto &&p : outer) {
+			min = glm::min(min, glm::vec2(p));
+			max = glm::max(max, glm::vec2(p));
+		}
+		min = glm::floor(min);
+		glm::ivec2 size(glm::ceil(max-min));
+		if(size.x <= 0 || size.y <= 0) {
+			continue;
+		}
+		Output out;
+		out.name = d.first;
+		out.area.set(min, size.x, size.y);
+		out.pixels.allocate(size.x, size.y, OF_PIXELS_RGBA);
+		fill(out.pixels, {0,0,0,1});
+		auto mesh = d.second->createMesh(resample_interval, tex_scale);
+		float *dst = out.pixels.getData();
+		rasterize(mesh, size.x, size.y, min, [&](const Span &span) {
+			float *row = dst+(std::size_t(span.y)*size.x+span.x0)*4;
+			for(int i = 0; i < span.size; ++i) {
+				if(!span.mask[i]) continue;
+				glm::vec4 c = sampleBilinear(src, span.u[i], span.v[i]);
+				// ofxBlendScreen::createMesh carries the ramp in the vertex colors
+				float att = blendCurve(span.r[i]*span.a[i], params.blend_power, params.luminance_control);
+				glm::vec3 rgb = glm::vec3(c)*glm::pow(glm::vec3(att), gamma_inv);
+				rgb = base_color + rgb*(1.f-base_color);
+				blendOver(row+i*4, glm::vec4(rgb, c.a));
+			}
+		});
+		ret.emplace_back(std::move(out));
+	}
+	return ret;
+}
+
+int run(const std::vector<std::string> &args)
+{
+	using Clock = std::chrono::steady_clock;
+	if(args.size() < 2) {
+		ofLogError("render") << "usage: --render project_folder source_image [output_folder]";
+		return 1;
+	}
+	ProjectFolder proj;
+	if(!proj.setRelative(args[0]) || !proj.isValid()) {
+		ofLogError("render") << "project folder not found: " << args[0];
+		return 1;
+	}
+	proj.setup();
+	ofFloatPixels source;
+	if(!ofLoadImage(source, args[1])) {
+		ofLogError("render") << "failed to load " << args[1];
+		return 1;
+	}
+	// stored coordinates are normalized, so unpacking with the actual source size fits the data to it
+	auto warping = std::make_shared<WarpingData>();
+	auto blending = std::make_shared<BlendingData>();
+	glm::vec2 bridge_size = proj.getBridgeResolution();
+	SaveData loader;
+	warping->setUnpackArg({source.getWidth(), source.getHeight()});
+	loader.append((char *)"warp", warping);
+	blending->setUnpackArg(bridge_size);
+	loader.append((char *)"blnd", blending);
+	if(!SaveData::withFileReader(proj.getDataFilePath(), [&loader](ByteReader &reader) { loader.unpack(reader); })) {
+		ofLogError("render") << "data file not found: " << proj.getDataFilePath();
+		return 1;
+	}
+	warping->update();
+	warping->setTessellationTolerance(proj.getTessellationTolerance());
+
+	auto start = Clock::now();
+	auto bridge = renderWarp(source, *warping, bridge_size, proj.getExportWarpParam().max_mesh_size);
+	auto warped = Clock::now();
+	auto outputs = renderOutputs(bridge, *blending, proj.getBlendParams(), proj.getExportBlendParam().max_mesh_size);
+	auto blended = Clock::now();
+	auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+	std::cout << "warp: " << ms(warped-start) << "ms, blend: " << ms(blended-warped) << "ms for " << outputs.size() << " outputs" << std::endl;
+
+	std::filesystem::path folder = args.size() > 2 ? std::filesystem::path(args[2]) : proj.getAbsolute("render");
+	std::error_code ec;
+	std::filesystem::create_directories(folder, ec);
+	bool ok = savePixels(bridge, folder/"bridge.png");
+	for(auto &&out : outputs) {
+		ok &= savePixels(out.pixels, folder/(out.name+".png"));
+	}
+	return ok ? 0 : 1;
+}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "MeshData.h"
+#include "ofxBlendScreen.h"
+#include "ofPixels.h"
+#include "ofRectangle.h"
+#include <string>
+#include <vector>
+
+// renders what GuiApp and ResultView draw, without a GL context.
+// meant as a reference to validate projects on machines that have no GPU.
+namespace render {
+struct Output {
+	std::string name;
+	// region of the bridge image this output covers
+	ofRectangle area;
+	ofFloatPixels pixels;
+};
+
+// the source warped into the bridge image, same as the fbo pass in GuiApp::update
+ofFloatPixels renderWarp(const ofFloatPixels &source, const WarpingData &data, const glm::ivec2 &bridge_size, float resample_interval=100);
+// one image per visible blending mesh, cropped to its outer quad, with the ofxBlendScreen::Shader math applied
+std::vector<Output> renderOutputs(const ofFloatPixels &bridge, const BlendingData &data, const ofxBlendScreen::Shader::Params &params, float resample_interval=100);
+
+// attenuation for a blend ramp value in [0,1], shaped by blend_power and luminance_control
+float blendCurve(float ramp, float blend_power, float luminance_control);
+
+// WarpingEditor --render project_folder source_image [output_folder]
+// writes bridge.png and one png per output. output_folder defaults to "render" in the project folder.
+int run(const std::vector<std::string> &args);
+}
@@ -0,0 +1,71 @@
+#include "LookupTable.h"
+#include "Rasterizer.h"
+#include "CpuRenderer.h"
+#include "ByteBuffer.h"
+#include "ofLog.h"
+#include <fstream>
+
+namespace {
+render::LookupTable makeTable(const glm::ivec2 &size, int channels, float initial_value)
+{
+	render::LookupTable ret;
+	ret.width = size.x;
+	ret.height = size.y;
+	ret.channels = channels;
+	ret.data.assign(std::size_t(size.x)*size.y*channels, initial_value);
+	return ret;
+}
+}
+
+namespace render {
+bool LookupTable::save(const std::filesystem::path &filepath) const
+{
+	ByteWriter writer;
+	writer.reserve(20+data.size()*sizeof(float));
+	writer.write("flut", 4);
+	writer.writeLE<uint32_t>(VERSION);
+	writer.writeLE<uint32_t>(width);
+	writer.writeLE<uint32_t>(height);
+	writer.writeLE<uint32_t>(channels);
+	writer.writeArrayLE(data.data(), data.size());
+	std::ofstream file(filepath, std::ios::binary);
+	if(!file.write(writer.data(), writer.size())) {
+		ofLogError("LookupTable") << "failed to write " << filepath;
+		return false;
+	}
+	return true;
+}
+
+LookupTable makeUVMap(const WarpingData &data, const glm::vec2 &coord_size, const glm::ivec2 &bridge_size, float resample_interval)
+{
+	auto ret = makeTable(bridge_size, 2, -1);
+	auto mesh = data.getMeshForExport(resample_interval, coord_size);
+	rasterize(mesh, ret.width, ret.height, {0,0}, [&](const Span &span) {
+		float *dst = ret.at(span.x0, span.y);
+		for(int i = 0; i < span.size; ++i, dst += 2) {
+			if(!span.mask[i]) continue;
+			dst[0] = span.u[i];
+			dst[1] = span.v[i];
+		}
+	});
+	return ret;
+}
+
+LookupTable makeBlendMap(const BlendingData &data, const ofxBlendScreen::Shader::Params &params, const glm::ivec2 &bridge_size, float resample_interval)
+{
+	auto ret = makeTable(bridge_size, 3, 0);
+	glm::vec3 gamma_inv = 1.f/glm::max(glm::vec3(params.gamma[0], params.gamma[1], params.gamma[2]), glm::vec3(1e-4f));
+	auto mesh = data.getMeshForExport(resample_interval, {1.f/bridge_size.x, 1.f/bridge_size.y});
+	rasterize(mesh, ret.width, ret.height, {0,0}, [&](const Span &span) {
+		float *dst = ret.at(span.x0, span.y);
+		for(int i = 0; i < span.size; ++i, dst += 3) {
+			if(!span.mask[i]) continue;
+			float att = blendCurve(span.r[i]*span.a[i], params.blend_power, params.luminance_control);
+			for(int c = 0; c < 3; ++c) {
+				dst[c] = std::pow(att, gamma_inv[c]);
+			}
+		}
+	});
+	return ret;
+}
+}
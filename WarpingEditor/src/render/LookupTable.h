@@ -0,0 +1,29 @@
+#pragma once
+
+#include "MeshData.h"
+#include "ofxBlendScreen.h"
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+
+// per pixel maps at the bridge resolution that replace the warp and blend meshes
+// for media servers that only take remap textures.
+namespace render {
+struct LookupTable {
+	int width=0, height=0, channels=0;
+	// row major from the top row, channels interleaved
+	std::vector<float> data;
+
+	float* at(int x, int y) { return data.data()+(std::size_t(y)*width+x)*channels; }
+	// "flut" | u32 version | u32 width | u32 height | u32 channels | float32 data, all little endian
+	bool save(const std::filesystem::path &filepath) const;
+	static const uint32_t VERSION = 1;
+};
+
+// uv of the source for each bridge pixel, scaled by coord_size like WarpingData::exportMesh.
+// pixels not covered by any visible mesh are (-1,-1).
+LookupTable makeUVMap(const WarpingData &data, const glm::vec2 &coord_size, const glm::ivec2 &bridge_size, float resample_interval);
+// per channel multiplier of the blend shader for each bridge pixel: pow(blendCurve(ramp), 1/gamma).
+// the shaded color is base_color + src*map*(1-base_color). uncovered pixels are 0.
+LookupTable makeBlendMap(const BlendingData &data, const ofxBlendScreen::Shader::Params &params, const glm::ivec2 &bridge_size, float resample_interval);
+}
@@ -0,0 +1,212 @@
+#include "Rasterizer.h"
+#include "JobPool.h"
+#include "ofLog.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const int TILE_SIZE = 64;
+
+struct Triangle {
+	glm::vec2 p[3];
+	glm::vec2 uv[3];
+	glm::vec4 color[3];
+	// inclusive pixel bounds, clipped to the target
+	int min_x, min_y, max_x, max_y;
+};
+
+float cross(const glm::vec2 &a, const glm::vec2 &b) { return a.x*b.y-a.y*b.x; }
+
+std::vector<Triangle> setupTriangles(const ofMesh &mesh, int width, int height, const glm::vec2 &origin)
+{
+	std::vector<Triangle> ret;
+	if(mesh.getMode() != OF_PRIMITIVE_TRIANGLES) {
+		ofLogWarning("render::rasterize") << "only OF_PRIMITIVE_TRIANGLES is supported";
+		return ret;
+	}
+	auto &&vertices = mesh.getVertices();
+	auto &&uvs = mesh.getTexCoords();
+	auto &&colors = mesh.getColors();
+	bool has_uv = uvs.size() == vertices.size();
+	bool has_color = colors.size() == vertices.size();
+	std::size_t num_indices = mesh.hasIndices() ? mesh.getNumIndices() : vertices.size();
+	ret.reserve(num_indices/3);
+	for(std::size_t i = 0; i+2 < num_indices; i += 3) {
+		Triangle t;
+		for(int j = 0; j < 3; ++j) {
+			std::size_t index = mesh.hasIndices() ? mesh.getIndex(i+j) : i+j;
+			t.p[j] = glm::vec2(vertices[index])-origin;
+			t.uv[j] = has_uv ? uvs[index] : glm::vec2(0,0);
+			t.color[j] = has_color ? glm::vec4(colors[index].r, colors[index].g, colors[index].b, colors[index].a) : glm::vec4(1,1,1,1);
+		}
+		float area = cross(t.p[1]-t.p[0], t.p[2]-t.p[0]);
+		if(std::abs(area) < 1e-8f) {
+			continue;
+		}
+		// same winding for every triangle so that the edge functions are positive inside
+		if(area < 0) {
+			std::swap(t.p[1], t.p[2]);
+			std::swap(t.uv[1], t.uv[2]);
+			std::swap(t.color[1], t.color[2]);
+		}
+		glm::vec2 min = glm::min(t.p[0], glm::min(t.p[1], t.p[2]));
+		glm::vec2 max = glm::max(t.p[0], glm::max(t.p[1], t.p[2]));
+		// pixels whose center is in the bounding box
+		t.min_x = std::max<int>(0, std::ceil(min.x-0.5f));
+		t.min_y = std::max<int>(0, std::ceil(min.y-0.5f));
+		t.max_x = std::min<int>(width-1, std::floor(max.x-0.5f));
+		t.max_y = std::min<int>(height-1, std::floor(max.y-0.5f));
+		if(t.min_x > t.max_x || t.min_y > t.max_y) {
+			continue;
+		}
+		ret.push_back(t);
+	}
+	return ret;
+}
+
+// per row buffers of one worker. the loops over them have no branches so that they can be vectorized.
+struct SpanBuffer {
+	float w[3][TILE_SIZE];
+	float u[TILE_SIZE], v[TILE_SIZE];
+	float r[TILE_SIZE], g[TILE_SIZE], b[TILE_SIZE], a[TILE_SIZE];
+	uint8_t mask[TILE_SIZE];
+};
+
+void rasterizeInTile(const Triangle &t, int tile_x0, int tile_y0, int tile_x1, int tile_y1, SpanBuffer &buf, const std::function<void(const render::Span&)> &func)
+{
+	int x0 = std::max(t.min_x, tile_x0), x1 = std::min(t.max_x, tile_x1);
+	int y0 = std::max(t.min_y, tile_y0), y1 = std::min(t.max_y, tile_y1);
+	if(x0 > x1 || y0 > y1) {
+		return;
+	}
+	// edge function i is zero on the edge opposite to vertex i and positive inside.
+	// it is evaluated from the edge's endpoints in a fixed order and negated if the edge runs the other way,
+	// so that two triangles sharing an edge get exactly opposite values and never both cover a pixel.
+	float ex[3], ey[3], ox[3], oy[3];
+	bool is_top_left[3];
+	for(int i = 0; i < 3; ++i) {
+		auto a = t.p[(i+1)%3], b = t.p[(i+2)%3];
+		// pixels exactly on an edge belong to the triangle below a horizontal edge or right of the edge otherwise
+		glm::vec2 d = b-a;
+		is_top_left[i] = d.y < 0 || (d.y == 0 && d.x > 0);
+		float sign = 1;
+		if(a.y > b.y || (a.y == b.y && a.x > b.x)) {
+			std::swap(a, b);
+			sign = -1;
+		}
+		ex[i] = -(b.y-a.y)*sign;
+		ey[i] = (b.x-a.x)*sign;
+		ox[i] = a.x;
+		oy[i] = a.y;
+	}
+	// the edge functions are divided by the area only to interpolate
+	float inv_area = 1/cross(t.p[1]-t.p[0], t.p[2]-t.p[0]);
+	int n = x1-x0+1;
+	for(int y = y0; y <= y1; ++y) {
+		float py = y+0.5f;
+		int inside = 0;
+		for(int i = 0; i < 3; ++i) {
+			float row = ey[i]*(py-oy[i]);
+			float *w = buf.w[i];
+			for(int k = 0; k < n; ++k) {
+				w[k] = ex[i]*((x0+k+0.5f)-ox[i]) + row;
+			}
+		}
+		auto covers = [&](int i, int k) { return (buf.w[i][k] > 0) | ((buf.w[i][k] == 0) & is_top_left[i]); };
+		for(int k = 0; k < n; ++k) {
+			buf.mask[k] = covers(0, k) & covers(1, k) & covers(2, k);
+			inside += buf.mask[k];
+		}
+		if(inside == 0) {
+			continue;
+		}
+		auto interpolate = [&](float *dst, float a0, float a1, float a2) {
+			const float *w0 = buf.w[0], *w1 = buf.w[1], *w2 = buf.w[2];
+			for(int k = 0; k < n; ++k) {
+				dst[k] = (w0[k]*a0 + w1[k]*a1 + w2[k]*a2)*inv_area;
+			}
+		};
+		interpolate(buf.u, t.uv[0].x, t.uv[1].x, t.uv[2].x);
+		interpolate(buf.v, t.uv[0].y, t.uv[1].y, t.uv[2].y);
+		interpolate(buf.r, t.color[0].r, t.color[1].r, t.color[2].r);
+		interpolate(buf.g, t.color[0].g, t.color[1].g, t.color[2].g);
+		interpolate(buf.b, t.color[0].b, t.color[1].b, t.color[2].b);
+		interpolate(buf.a, t.color[0].a, t.color[1].a, t.color[2].a);
+		func({y, x0, n, buf.mask, buf.u, buf.v, buf.r, buf.g, buf.b, buf.a});
+	}
+}
+}
+
+namespace render {
+void rasterize(const ofMesh &mesh, int width, int height, const glm::vec2 &origin, const std::function<void(const Span&)> &func)
+{
+	if(width <= 0 || height <= 0) {
+		return;
+	}
+	auto triangles = setupTriangles(mesh, width, height, origin);
+	int tiles_x = (width+TILE_SIZE-1)/TILE_SIZE;
+	int tiles_y = (height+TILE_SIZE-1)/TILE_SIZE;
+	// binning keeps the order of the mesh inside each tile, so overlapping triangles resolve the same as on the GPU
+	std::vector<std::vector<uint32_t>> bins(tiles_x*tiles_y);
+	for(uint32_t i = 0; i < triangles.size(); ++i) {
+		auto &&t = triangles[i];
+		for(int ty = t.min_y/TILE_SIZE; ty <= t.max_y/TILE_SIZE; ++ty) {
+			for(int tx = t.min_x/TILE_SIZE; tx <= t.max_x/TILE_SIZE; ++tx) {
+				bins[ty*tiles_x+tx].push_back(i);
+			}
+		}
+	}
+	JobPool::shared().parallelFor(bins.size(), [&](std::size_t index) {
+		auto &&bin = bins[index];
+		if(bin.empty()) {
+			return;
+		}
+		int tile_x0 = (index%tiles_x)*TILE_SIZE;
+		int tile_y0 = (index/tiles_x)*TILE_SIZE;
+		int tile_x1 = std::min(tile_x0+TILE_SIZE, width)-1;
+		int tile_y1 = std::min(tile_y0+TILE_SIZE, height)-1;
+		SpanBuffer buf;
+		for(auto &&i : bin) {
+			rasterizeInTile(triangles[i], tile_x0, tile_y0, tile_x1, tile_y1, buf, func);
+		}
+	});
+}
+
+glm::vec4 sampleBilinear(const ofFloatPixels &pixels, float u, float v)
+{
+	int w = pixels.getWidth(), h = pixels.getHeight();
+	float x = u*w-0.5f, y = v*h-0.5f;
+	float fx = std::floor(x), fy = std::floor(y);
+	float tx = x-fx, ty = y-fy;
+	int x0 = ofClamp(fx, 0, w-1), x1 = ofClamp(fx+1, 0, w-1);
+	int y0 = ofClamp(fy, 0, h-1), y1 = ofClamp(fy+1, 0, h-1);
+	const float *data = pixels.getData();
+	auto at = [&](int x, int y) {
+		const float *p = data+(std::size_t(y)*w+x)*4;
+		return glm::vec4(p[0], p[1], p[2], p[3]);
+	};
+	return glm::mix(glm::mix(at(x0,y0), at(x1,y0), tx), glm::mix(at(x0,y1), at(x1,y1), tx), ty);
+}
+
+ofFloatPixels toRGBA(const ofFloatPixels &pixels)
+{
+	std::size_t num_channels = pixels.getNumChannels();
+	if(num_channels == 4) {
+		return pixels;
+	}
+	ofFloatPixels ret;
+	ret.allocate(pixels.getWidth(), pixels.getHeight(), OF_PIXELS_RGBA);
+	const float *src = pixels.getData();
+	float *dst = ret.getData();
+	std::size_t num_pixels = pixels.getWidth()*pixels.getHeight();
+	for(std::size_t i = 0; i < num_pixels; ++i, src += num_channels, dst += 4) {
+		// gray or gray+alpha, otherwise the first three channels are rgb
+		bool is_gray = num_channels < 3;
+		dst[0] = src[0];
+		dst[1] = is_gray ? src[0] : src[1];
+		dst[2] = is_gray ? src[0] : src[2];
+		dst[3] = num_channels == 2 ? src[1] : 1;
+	}
+	return ret;
+}
+}
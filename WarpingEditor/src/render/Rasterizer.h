@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ofMesh.h"
+#include "ofPixels.h"
+#include <functional>
+#include <cstdint>
+
+namespace render {
+// interpolated attributes of the pixels in one row span of a triangle.
+// arrays have `size` elements; element i belongs to pixel (x0+i, y).
+struct Span {
+	int y, x0, size;
+	// nonzero where the pixel center is inside the triangle.
+	// centers exactly on an edge follow the top-left rule, so a pixel on an edge shared by two triangles is covered once.
+	const uint8_t *mask;
+	const float *u, *v;
+	const float *r, *g, *b, *a;
+};
+
+// rasterizes the triangles of mesh into a width x height target.
+// vertex positions are in target pixels after subtracting origin. uv and color default to 0 and white if missing.
+// the target is split into tiles that run on the JobPool; func is called concurrently but never for the same pixel twice from different threads.
+void rasterize(const ofMesh &mesh, int width, int height, const glm::vec2 &origin, const std::function<void(const Span&)> &func);
+
+// bilinear filtering with clamp to edge. pixels must have 4 channels, uv is normalized.
+glm::vec4 sampleBilinear(const ofFloatPixels &pixels, float u, float v);
+
+// copies into a 4 channel image. missing alpha is filled with 1.
+ofFloatPixels toRGBA(const ofFloatPixels &pixels);
+}
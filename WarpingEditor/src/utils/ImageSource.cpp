@@ -2,6 +2,15 @@
 #include "ofImage.h"
 #include "ofFileUtils.h"
 #include "ofVideoPlayer.h"
+#include "ofUtils.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <deque>
+#include <map>
+#include <set>
+#include <condition_variable>
 
 namespace {
 class ImageFile : public ImageSourceImpl {
@@ -14,23 +23,251 @@ public:
 protected:
 	ofTexture texture_;
 };
+// the player lives on its own thread and only decodes into pixels there.
+// decoded frames wait in a small queue until update uploads the newest one on the GL thread,
+// so a slow codec no longer stalls the editor.
 class VideoFile : public ImageSourceImpl {
 public:
+	~VideoFile() {
+		is_exiting_ = true;
+		if(worker_.joinable()) {
+			worker_.join();
+		}
+	}
 	bool load(const std::filesystem::path &filepath) {
-		player_.setUseTexture(true);
-		bool ret = player_.load(filepath.string());
-		player_.setLoopState(OF_LOOP_NORMAL);
-		player_.play();
-		return ret;
+		std::promise<bool> loaded;
+		auto result = loaded.get_future();
+		worker_ = std::thread([this, filepath, &loaded]() {
+			ofVideoPlayer player;
+			player.setUseTexture(false);
+			bool ret = player.load(filepath.string());
+			loaded.set_value(ret);
+			if(!ret) {
+				return;
+			}
+			player.setLoopState(OF_LOOP_NORMAL);
+			player.play();
+			decode(player);
+			player.close();
+		});
+		return result.get();
+	}
+	void update() override {
+		is_frame_new_ = false;
+		ofPixels frame;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if(queue_.empty()) {
+				return;
+			}
+			// only the newest one is shown, older ones would just add latency
+			frame.swap(queue_.back());
+			queue_.pop_back();
+			while(!queue_.empty()) {
+				recycle(std::move(queue_.front()));
+				queue_.pop_front();
+			}
+		}
+		if(!texture_.isAllocated() || texture_.getWidth() != frame.getWidth() || texture_.getHeight() != frame.getHeight()) {
+			texture_.allocate(frame);
+		}
+		texture_.loadData(frame);
+		is_frame_new_ = true;
+		std::lock_guard<std::mutex> lock(mutex_);
+		recycle(std::move(frame));
+	}
+	bool isFrameNew() const override { return is_frame_new_; }
+	ofTexture& getTexture() override { return texture_; }
+	const ofTexture& getTexture() const override { return texture_; };
+private:
+	static const std::size_t MAX_QUEUED_FRAMES = 3;
+	std::thread worker_;
+	std::atomic<bool> is_exiting_{false};
+	std::mutex mutex_;
+	std::deque<ofPixels> queue_;
+	// buffers of frames already shown, reused to avoid reallocating per frame
+	std::vector<ofPixels> pool_;
+	ofTexture texture_;
+	bool is_frame_new_=false;
+
+	void decode(ofVideoPlayer &player) {
+		while(!is_exiting_) {
+			player.update();
+			if(!player.isFrameNew()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+			auto &&src = player.getPixels();
+			ofPixels frame;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if(!pool_.empty()) {
+					frame.swap(pool_.back());
+					pool_.pop_back();
+				}
+			}
+			frame = src;
+			std::lock_guard<std::mutex> lock(mutex_);
+			// drop the oldest when the GL thread can't keep up
+			if(queue_.size() >= MAX_QUEUED_FRAMES) {
+				recycle(std::move(queue_.front()));
+				queue_.pop_front();
+			}
+			queue_.emplace_back(std::move(frame));
+		}
+	}
+	// call with mutex_ locked
+	void recycle(ofPixels &&frame) {
+		if(pool_.size() < MAX_QUEUED_FRAMES) {
+			pool_.emplace_back(std::move(frame));
+		}
+	}
+};
+
+// frames from the playhead onward are decoded ahead on worker threads into a bounded cache.
+// update shows whatever frame the clock points at, or keeps the previous one if it isn't ready yet.
+class ImageSequence : public ImageSourceImpl {
+public:
+	~ImageSequence() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			is_exiting_ = true;
+		}
+		wake_.notify_all();
+		for(auto &&w : workers_) {
+			w.join();
+		}
+	}
+	bool load(const std::filesystem::path &folder, float fps) {
+		ofDirectory dir(folder);
+		for(auto &&ext : {"png","jpg","jpeg","tif","tiff","bmp","exr"}) {
+			dir.allowExt(ext);
+		}
+		dir.listDir();
+		dir.sort();
+		for(std::size_t i = 0; i < dir.size(); ++i) {
+			files_.push_back(dir.getPath(i));
+		}
+		if(files_.empty()) {
+			ofLogWarning("ImageSequence") << "no image found in " << folder;
+			return false;
+		}
+		fps_ = std::max(fps, 0.001f);
+		start_time_ = ofGetElapsedTimeMillis();
+		for(int i = 0; i < NUM_WORKERS; ++i) {
+			workers_.emplace_back(&ImageSequence::work, this);
+		}
+		return true;
 	}
 	void update() override {
-		player_.update();
+		is_frame_new_ = false;
+		int index = uint64_t((ofGetElapsedTimeMillis()-start_time_)*fps_/1000) % files_.size();
+		std::shared_ptr<const Frame> frame;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if(index != playhead_) {
+				playhead_ = index;
+				for(auto it = begin(cache_); it != end(cache_);) {
+					it = isInWindow(it->first) ? std::next(it) : cache_.erase(it);
+				}
+				wake_.notify_all();
+			}
+			if(index == shown_) {
+				return;
+			}
+			auto found = cache_.find(index);
+			if(found == end(cache_)) {
+				return;
+			}
+			frame = found->second;
+		}
+		shown_ = index;
+		if(frame->is_float ? !frame->float_pixels.isAllocated() : !frame->pixels.isAllocated()) {
+			return;
+		}
+		if(frame->is_float) upload(frame->float_pixels);
+		else upload(frame->pixels);
+		is_frame_new_ = true;
 	}
-	bool isFrameNew() const override { return player_.isFrameNew(); }
-	ofTexture& getTexture() override { return player_.getTexture(); }
-	const ofTexture& getTexture() const override { return player_.getTexture(); };
+	bool isFrameNew() const override { return is_frame_new_; }
+	ofTexture& getTexture() override { return texture_; }
+	const ofTexture& getTexture() const override { return texture_; };
 private:
-	ofVideoPlayer player_;
+	static const int PREFETCH_FRAMES = 8;
+	static const int NUM_WORKERS = 2;
+	struct Frame {
+		ofPixels pixels;
+		ofFloatPixels float_pixels;
+		bool is_float=false;
+	};
+	std::vector<std::filesystem::path> files_;
+	float fps_=30;
+	uint64_t start_time_=0;
+	ofTexture texture_;
+	int shown_=-1;
+	bool is_frame_new_=false;
+
+	std::vector<std::thread> workers_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::map<int, std::shared_ptr<const Frame>> cache_;
+	std::set<int> loading_;
+	int playhead_=0;
+	bool is_exiting_=false;
+
+	template<typename Pixels>
+	void upload(const Pixels &pixels) {
+		if(!texture_.isAllocated() || texture_.getWidth() != pixels.getWidth() || texture_.getHeight() != pixels.getHeight()) {
+			texture_.allocate(pixels);
+		}
+		texture_.loadData(pixels);
+	}
+	// call with mutex_ locked
+	bool isInWindow(int index) const {
+		int ahead = (index - playhead_ + (int)files_.size()) % (int)files_.size();
+		return ahead < PREFETCH_FRAMES;
+	}
+	// call with mutex_ locked. the nearest frame from the playhead comes first.
+	bool findNextToLoad(int &index) const {
+		int num = std::min<int>(PREFETCH_FRAMES, files_.size());
+		for(int i = 0; i < num; ++i) {
+			int candidate = (playhead_ + i) % files_.size();
+			if(cache_.count(candidate) == 0 && loading_.count(candidate) == 0) {
+				index = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+	void work() {
+		while(true) {
+			int index;
+			std::filesystem::path path;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				wake_.wait(lock, [&]{ return is_exiting_ || findNextToLoad(index); });
+				if(is_exiting_) {
+					return;
+				}
+				loading_.insert(index);
+				path = files_[index];
+			}
+			auto frame = std::make_shared<Frame>();
+			// float formats keep their range
+			auto ext = ofToLower(path.extension().string());
+			frame->is_float = ext == ".exr";
+			bool loaded = frame->is_float ? ofLoadImage(frame->float_pixels, path) : ofLoadImage(frame->pixels, path);
+			if(!loaded) {
+				ofLogWarning("ImageSequence") << "failed to load " << path;
+			}
+			std::lock_guard<std::mutex> lock(mutex_);
+			loading_.erase(index);
+			// a broken file is cached as it is so that it won't be retried every frame
+			if(isInWindow(index)) {
+				cache_[index] = frame;
+			}
+		}
+	}
 };
 }
 
@@ -60,3 +297,13 @@ bool ImageSource::loadFromFile(const std::filesystem::path &filepath)
 	return false;
 }
 
+bool ImageSource::loadSequence(const std::filesystem::path &folder, float fps)
+{
+	auto impl = std::make_shared<ImageSequence>();
+	bool ret = impl->load(folder, fps);
+	if(ret) {
+		impl_ = impl;
+	}
+	return ret;
+}
+
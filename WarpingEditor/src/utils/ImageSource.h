@@ -17,6 +17,8 @@ class ImageSource : public ofBaseHasTexture
 {
 public:
 	bool loadFromFile(const std::filesystem::path &filepath);
+	// plays the image files in the folder in the order of their names
+	bool loadSequence(const std::filesystem::path &folder, float fps);
 	template<typename T>
 	bool setupNDI(T &&source);
 	void update() { impl_->update(); }
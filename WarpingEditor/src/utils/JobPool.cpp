@@ -0,0 +1,106 @@
+#include "JobPool.h"
+
+namespace {
+// set while a thread runs items of a job, so that parallelFor from inside an item runs inline
+// instead of waiting on the pool it is occupying
+thread_local bool is_in_job = false;
+}
+
+JobPool& JobPool::shared()
+{
+	static JobPool pool;
+	return pool;
+}
+
+JobPool::JobPool(std::size_t num_threads)
+{
+	// the calling thread also works, so one less is enough
+	for(std::size_t i = 1; i < num_threads; ++i) {
+		workers_.emplace_back(&JobPool::threadFunc, this);
+	}
+}
+
+JobPool::~JobPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		is_exiting_ = true;
+	}
+	wake_.notify_all();
+	for(auto &&w : workers_) {
+		w.join();
+	}
+}
+
+void JobPool::parallelFor(std::size_t count, const std::function<void(std::size_t)> &func)
+{
+	if(count == 0) {
+		return;
+	}
+	if(count == 1 || workers_.empty() || is_in_job) {
+		for(std::size_t i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+	std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+	auto job = std::make_shared<Job>();
+	job->func = &func;
+	job->count = count;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		job_ = job;
+		++generation_;
+	}
+	wake_.notify_all();
+	work(*job);
+	std::unique_lock<std::mutex> lock(mutex_);
+	finish_.wait(lock, [&]{ return job->done == job->count; });
+	job_.reset();
+	lock.unlock();
+	if(job->error) {
+		std::rethrow_exception(job->error);
+	}
+}
+
+void JobPool::work(Job &job)
+{
+	bool was_in_job = is_in_job;
+	is_in_job = true;
+	std::size_t i;
+	while((i = job.next++) < job.count) {
+		try {
+			(*job.func)(i);
+		}
+		catch(...) {
+			// the rest still runs so that done reaches count; the first error is rethrown by parallelFor
+			std::lock_guard<std::mutex> lock(mutex_);
+			if(!job.error) {
+				job.error = std::current_exception();
+			}
+		}
+		if(++job.done == job.count) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			finish_.notify_all();
+		}
+	}
+	is_in_job = was_in_job;
+}
+
+void JobPool::threadFunc()
+{
+	std::size_t generation = 0;
+	while(true) {
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			wake_.wait(lock, [&]{ return is_exiting_ || (job_ && generation_ != generation); });
+			if(is_exiting_) {
+				return;
+			}
+			generation = generation_;
+			job = job_;
+		}
+		work(*job);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+class JobPool
+{
+public:
+	static JobPool& shared();
+	
+	JobPool(std::size_t num_threads=std::thread::hardware_concurrency());
+	~JobPool();
+	
+	// calls func(0)...func(count-1) on the worker threads and the calling thread. blocks until all done.
+	// called from inside func, it runs inline on that thread. the first exception thrown by func is rethrown here.
+	void parallelFor(std::size_t count, const std::function<void(std::size_t)> &func);
+	std::size_t getNumThreads() const { return workers_.size()+1; }
+private:
+	struct Job {
+		const std::function<void(std::size_t)> *func=nullptr;
+		std::size_t count=0;
+		std::atomic<std::size_t> next{0};
+		std::atomic<std::size_t> done{0};
+		std::exception_ptr error;
+	};
+	std::vector<std::thread> workers_;
+	std::mutex mutex_, submit_mutex_;
+	std::condition_variable wake_, finish_;
+	std::shared_ptr<Job> job_;
+	std::size_t generation_=0;
+	bool is_exiting_=false;
+	
+	void work(Job &job);
+	void threadFunc();
+};
@@ -0,0 +1,75 @@
+#include "PointBatch.h"
+#include "ofGraphics.h"
+
+namespace {
+const int CIRCLE_RESOLUTION = 16;
+const int INSTANCE_ATTRIBUTE = 4;
+const int INSTANCE_COLOR_ATTRIBUTE = 5;
+
+const char *VERTEX_SHADER = R"(
+#version 410
+uniform mat4 modelViewProjectionMatrix;
+layout(location=0) in vec4 position;
+layout(location=4) in vec3 instance;
+layout(location=5) in vec4 instance_color;
+out vec4 v_color;
+void main() {
+	v_color = instance_color;
+	gl_Position = modelViewProjectionMatrix * vec4(instance.xy + position.xy*instance.z, 0.0, 1.0);
+}
+)";
+const char *FRAGMENT_SHADER = R"(
+#version 410
+in vec4 v_color;
+out vec4 fragColor;
+void main() {
+	fragColor = v_color;
+}
+)";
+}
+
+std::shared_ptr<ofShader> PointBatch::getShader()
+{
+	static std::shared_ptr<ofShader> shader;
+	if(!shader) {
+		shader = std::make_shared<ofShader>();
+		shader->setupShaderFromSource(GL_VERTEX_SHADER, VERTEX_SHADER);
+		shader->setupShaderFromSource(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+		shader->bindDefaults();
+		if(!shader->linkProgram()) {
+			ofLogError("PointBatch") << "failed to link shader";
+		}
+	}
+	return shader;
+}
+
+void PointBatch::draw() const
+{
+	if(instance_.empty()) {
+		return;
+	}
+	if(!vbo_.getIsAllocated()) {
+		// unit circle as a triangle fan
+		std::vector<glm::vec3> circle;
+		circle.reserve(CIRCLE_RESOLUTION+2);
+		circle.emplace_back(0,0,0);
+		float angle = TWO_PI/(float)CIRCLE_RESOLUTION;
+		for(int i = 0; i <= CIRCLE_RESOLUTION; ++i) {
+			circle.emplace_back(cos(angle*i), sin(angle*i), 0);
+		}
+		vbo_.setVertexData(circle.data(), (int)circle.size(), GL_STATIC_DRAW);
+	}
+	if(capacity_ < instance_.size()) {
+		capacity_ = std::max(instance_.size(), capacity_*2);
+		buffer_.allocate(capacity_*sizeof(Instance), GL_STREAM_DRAW);
+		vbo_.setAttributeBuffer(INSTANCE_ATTRIBUTE, buffer_, 3, sizeof(Instance), offsetof(Instance, center));
+		vbo_.setAttributeDivisor(INSTANCE_ATTRIBUTE, 1);
+		vbo_.setAttributeBuffer(INSTANCE_COLOR_ATTRIBUTE, buffer_, 4, sizeof(Instance), offsetof(Instance, color));
+		vbo_.setAttributeDivisor(INSTANCE_COLOR_ATTRIBUTE, 1);
+	}
+	buffer_.updateData(0, instance_.size()*sizeof(Instance), instance_.data());
+	auto shader = getShader();
+	shader->begin();
+	vbo_.drawInstanced(GL_TRIANGLE_FAN, 0, CIRCLE_RESOLUTION+2, (int)instance_.size());
+	shader->end();
+}
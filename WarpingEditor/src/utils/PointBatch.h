@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ofVbo.h"
+#include "ofBufferObject.h"
+#include "ofShader.h"
+#include "ofColor.h"
+#include <vector>
+#include <memory>
+
+// draws many filled circles in one instanced call.
+// the circle is a shared template mesh; only center, radius and color are uploaded per point.
+class PointBatch
+{
+public:
+	void clear() { instance_.clear(); }
+	void add(const glm::vec2 &center, const ofFloatColor &color, float radius) {
+		instance_.push_back({center, radius, color});
+	}
+	std::size_t size() const { return instance_.size(); }
+	void draw() const;
+private:
+	struct Instance {
+		glm::vec2 center;
+		float radius;
+		ofFloatColor color;
+	};
+	std::vector<Instance> instance_;
+	mutable ofVbo vbo_;
+	mutable ofBufferObject buffer_;
+	mutable std::size_t capacity_=0;
+	
+	static std::shared_ptr<ofShader> getShader();
+};
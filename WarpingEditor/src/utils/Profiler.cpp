@@ -0,0 +1,315 @@
+#include "Profiler.h"
+#include "imgui.h"
+#include "ofLog.h"
+#include "ofUtils.h"
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <cmath>
+
+struct Profiler::ThreadLog {
+	int index;
+	std::mutex mutex;
+	std::vector<Profiler::Event> event;
+	std::size_t head=0, count=0;
+	// total pushed, and how many of them newFrame has already collected
+	std::uint64_t num_pushed=0, num_collected=0;
+	int depth=0;
+	void push(const Profiler::Event &e) {
+		std::lock_guard<std::mutex> lock(mutex);
+		event[head] = e;
+		head = (head+1)%event.size();
+		count = std::min(count+1, event.size());
+		++num_pushed;
+	}
+};
+
+namespace {
+const std::size_t EVENTS_PER_THREAD = 1<<14;
+const std::size_t FRAME_HISTORY = 240;
+
+double toMs(std::int64_t ns) { return ns/1000000.0; }
+}
+
+Profiler& Profiler::shared()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler()
+:start_(std::chrono::steady_clock::now())
+,frame_ms_(FRAME_HISTORY, 0)
+{
+	frame_.reserve(FRAME_HISTORY);
+}
+
+Profiler::ZoneStat::ZoneStat(float hue)
+:ms(FRAME_HISTORY, 0)
+,hue(hue)
+{
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+	if(is_enabled_.exchange(enabled) || !enabled) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(frame_mutex_);
+	frame_.clear();
+	frame_head_ = 0;
+	stat_head_ = num_stat_frames_ = 0;
+	last_frame_.clear();
+}
+
+std::int64_t Profiler::now() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start_).count();
+}
+
+Profiler::ThreadLog& Profiler::getThreadLog()
+{
+	thread_local ThreadLog *log = nullptr;
+	if(!log) {
+		auto created = std::make_shared<ThreadLog>();
+		created->event.resize(EVENTS_PER_THREAD);
+		std::lock_guard<std::mutex> lock(threads_mutex_);
+		created->index = (int)threads_.size();
+		threads_.push_back(created);
+		log = created.get();
+	}
+	return *log;
+}
+
+Profiler::Scope::Scope(const char *name)
+:log_(nullptr)
+,name_(name)
+{
+	auto &&profiler = Profiler::shared();
+	if(!profiler.isEnabled()) {
+		return;
+	}
+	log_ = &profiler.getThreadLog();
+	++log_->depth;
+	begin_ = profiler.now();
+}
+Profiler::Scope::~Scope()
+{
+	if(!log_) {
+		return;
+	}
+	--log_->depth;
+	log_->push({name_, begin_, Profiler::shared().now(), log_->depth});
+}
+
+void Profiler::newFrame()
+{
+	if(!isEnabled()) {
+		return;
+	}
+	auto t = now();
+	std::lock_guard<std::mutex> lock(frame_mutex_);
+	bool has_last = !frame_.empty();
+	std::int64_t last = has_last ? frame_[(frame_head_+frame_.size()-1)%frame_.size()] : 0;
+	if(frame_.size() < FRAME_HISTORY) {
+		frame_.push_back(t);
+	}
+	else {
+		frame_[frame_head_] = t;
+		frame_head_ = (frame_head_+1)%FRAME_HISTORY;
+	}
+	collectEvents();
+	if(!has_last) {
+		// the events so far do not belong to a complete frame
+		for(auto &&z : zone_) {
+			z.second.current = 0;
+		}
+		return;
+	}
+	frame_ms_[stat_head_] = toMs(t-last);
+	for(auto &&z : zone_) {
+		z.second.ms[stat_head_] = z.second.current;
+		z.second.current = 0;
+	}
+	stat_head_ = (stat_head_+1)%FRAME_HISTORY;
+	num_stat_frames_ = std::min(num_stat_frames_+1, FRAME_HISTORY);
+}
+
+void Profiler::collectEvents()
+{
+	std::vector<std::shared_ptr<ThreadLog>> threads;
+	{
+		std::lock_guard<std::mutex> lock(threads_mutex_);
+		threads = threads_;
+	}
+	last_frame_.resize(threads.size());
+	for(std::size_t i = 0; i < threads.size(); ++i) {
+		auto &&t = *threads[i];
+		auto &&dst = last_frame_[i];
+		dst.thread_index = t.index;
+		dst.event.clear();
+		{
+			std::lock_guard<std::mutex> lock(t.mutex);
+			// events overwritten before being collected are lost
+			std::size_t fresh = (std::size_t)std::min<std::uint64_t>(t.num_pushed-t.num_collected, t.count);
+			std::size_t first = (t.head+t.event.size()-fresh)%t.event.size();
+			for(std::size_t j = 0; j < fresh; ++j) {
+				dst.event.push_back(t.event[(first+j)%t.event.size()]);
+			}
+			t.num_collected = t.num_pushed;
+		}
+		for(auto &&e : dst.event) {
+			auto found = zone_.find(e.name);
+			if(found == end(zone_)) {
+				float hue = std::fmod(zone_order_.size()*0.618034f, 1.f);
+				found = zone_.emplace(e.name, ZoneStat(hue)).first;
+				zone_order_.push_back(e.name);
+			}
+			found->second.current += toMs(e.end-e.begin);
+		}
+	}
+}
+
+std::vector<std::int64_t> Profiler::getFrames() const
+{
+	std::lock_guard<std::mutex> lock(frame_mutex_);
+	std::vector<std::int64_t> ret(frame_.size());
+	for(std::size_t i = 0; i < frame_.size(); ++i) {
+		ret[i] = frame_[(frame_head_+i)%frame_.size()];
+	}
+	return ret;
+}
+
+std::vector<Profiler::ThreadEvents> Profiler::getEvents() const
+{
+	std::vector<std::shared_ptr<ThreadLog>> threads;
+	{
+		std::lock_guard<std::mutex> lock(threads_mutex_);
+		threads = threads_;
+	}
+	std::vector<ThreadEvents> ret;
+	for(auto &&t : threads) {
+		ThreadEvents events;
+		events.thread_index = t->index;
+		{
+			std::lock_guard<std::mutex> lock(t->mutex);
+			std::size_t first = (t->head+t->event.size()-t->count)%t->event.size();
+			events.event.reserve(t->count);
+			for(std::size_t i = 0; i < t->count; ++i) {
+				events.event.push_back(t->event[(first+i)%t->event.size()]);
+			}
+		}
+		ret.push_back(std::move(events));
+	}
+	return ret;
+}
+
+bool Profiler::dumpTrace(const std::filesystem::path &filepath) const
+{
+	std::ofstream file(filepath);
+	if(!file) {
+		ofLogError("Profiler") << "failed to open " << filepath;
+		return false;
+	}
+	file << "{\"traceEvents\":[";
+	bool is_first = true;
+	char buf[64];
+	for(auto &&t : getEvents()) {
+		for(auto &&e : t.event) {
+			file << (is_first ? "\n" : ",\n");
+			is_first = false;
+			snprintf(buf, sizeof(buf), "%.3f,\"dur\":%.3f", e.begin/1000.0, (e.end-e.begin)/1000.0);
+			file << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << t.thread_index << ",\"ts\":" << buf << "}";
+		}
+	}
+	for(auto &&f : getFrames()) {
+		file << (is_first ? "\n" : ",\n");
+		is_first = false;
+		snprintf(buf, sizeof(buf), "%.3f", f/1000.0);
+		file << "{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":" << buf << "}";
+	}
+	file << "\n]}\n";
+	return file.good();
+}
+
+void Profiler::gui()
+{
+	using namespace ImGui;
+	bool enabled = isEnabled();
+	if(Checkbox("enabled", &enabled)) {
+		setEnabled(enabled);
+	}
+	SameLine();
+	if(Button("dump trace")) {
+		auto path = ofToDataPath("trace_"+ofGetTimestampString("%Y%m%d_%H%M%S")+".json", true);
+		if(dumpTrace(path)) {
+			ofLogNotice("Profiler") << "trace saved to " << path;
+		}
+	}
+	std::lock_guard<std::mutex> lock(frame_mutex_);
+	if(num_stat_frames_ == 0 || frame_.size() < 2) {
+		return;
+	}
+	std::vector<double> sorted;
+	auto showStat = [&sorted, this](const char *name, const std::vector<double> &ms) {
+		sorted.assign(begin(ms), begin(ms)+num_stat_frames_);
+		double mean = std::accumulate(begin(sorted), end(sorted), 0.0)/sorted.size();
+		std::sort(begin(sorted), end(sorted));
+		double p99 = sorted[std::min(sorted.size()-1, (std::size_t)(sorted.size()*0.99))];
+		Text("%s", name); NextColumn();
+		Text("%.3f", mean); NextColumn();
+		Text("%.3f", p99); NextColumn();
+	};
+	Text("last %d frames", (int)num_stat_frames_);
+	Columns(3, "profiler_stats");
+	Text("zone"); NextColumn();
+	Text("mean[ms]"); NextColumn();
+	Text("p99[ms]"); NextColumn();
+	Separator();
+	showStat("frame", frame_ms_);
+	for(auto &&name : zone_order_) {
+		showStat(name, zone_.at(name).ms);
+	}
+	Columns(1);
+	
+	// timeline of the last complete frame
+	std::int64_t t1 = frame_[(frame_head_+frame_.size()-1)%frame_.size()];
+	std::int64_t t0 = frame_[(frame_head_+frame_.size()-2)%frame_.size()];
+	const float row_height = GetTextLineHeight()+2;
+	float width = std::max(GetContentRegionAvail().x, 100.f);
+	double scale = width/double(std::max<std::int64_t>(t1-t0, 1));
+	auto draw_list = GetWindowDrawList();
+	for(auto &&t : last_frame_) {
+		int max_depth = -1;
+		for(auto &&e : t.event) {
+			max_depth = std::max(max_depth, e.depth);
+		}
+		if(max_depth < 0) continue;
+		Text("thread %d", t.thread_index);
+		ImVec2 origin = GetCursorScreenPos();
+		ImVec2 size(width, row_height*(max_depth+1));
+		PushID(t.thread_index);
+		InvisibleButton("timeline", size);
+		PopID();
+		bool hovered = IsItemHovered();
+		ImVec2 mouse = GetIO().MousePos;
+		draw_list->PushClipRect(origin, {origin.x+size.x, origin.y+size.y}, true);
+		for(auto &&e : t.event) {
+			float x0 = origin.x + float((std::max(e.begin, t0)-t0)*scale);
+			float x1 = origin.x + float((std::min(e.end, t1)-t0)*scale);
+			x1 = std::max(x1, x0+1);
+			float y0 = origin.y + e.depth*row_height;
+			ImVec2 lt(x0, y0), rb(x1, y0+row_height-1);
+			ImU32 color = ImColor::HSV(zone_.at(e.name).hue, 0.5f, 0.8f);
+			draw_list->AddRectFilled(lt, rb, color);
+			draw_list->PushClipRect(lt, rb, true);
+			draw_list->AddText({x0+2, y0}, IM_COL32_BLACK, e.name);
+			draw_list->PopClipRect();
+			if(hovered && lt.x <= mouse.x && mouse.x <= rb.x && lt.y <= mouse.y && mouse.y <= rb.y) {
+				SetTooltip("%s: %.3fms", e.name, toMs(e.end-e.begin));
+			}
+		}
+		draw_list->PopClipRect();
+	}
+}
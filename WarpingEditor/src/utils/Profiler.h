@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <thread>
+#include <filesystem>
+
+// scoped-zone profiler. each thread records into its own ring buffer.
+// usage: PROFILE_SCOPE("name"); the name must be a string literal.
+// zones are told apart by the address of the name, so each zone should be named in one place.
+// disabled by default; recording starts when it is enabled from the panel.
+class Profiler
+{
+	struct ThreadLog;
+public:
+	static Profiler& shared();
+	
+	struct Event {
+		const char *name;
+		std::int64_t begin, end;	// nanoseconds since the profiler was created
+		int depth;
+	};
+	class Scope {
+	public:
+		Scope(const char *name);
+		~Scope();
+	private:
+		ThreadLog *log_;
+		const char *name_;
+		std::int64_t begin_;
+	};
+	
+	// enabling starts the statistics over
+	void setEnabled(bool enabled);
+	bool isEnabled() const { return is_enabled_; }
+	// marks the beginning of a frame and aggregates the events of the previous one. call once per frame from the main thread.
+	void newFrame();
+	std::int64_t now() const;
+	
+	// draws the statistics and the timeline of the last frame into the current ImGui window
+	void gui();
+	// writes the recorded events in the chrome tracing format (chrome://tracing, perfetto)
+	bool dumpTrace(const std::filesystem::path &filepath) const;
+private:
+	Profiler();
+	struct ThreadEvents {
+		int thread_index;
+		std::vector<Event> event;
+	};
+	std::vector<ThreadEvents> getEvents() const;
+	std::vector<std::int64_t> getFrames() const;
+	ThreadLog& getThreadLog();
+	// moves the events recorded since the last call into last_frame_ and adds them to the zones
+	void collectEvents();
+	
+	std::chrono::steady_clock::time_point start_;
+	std::atomic<bool> is_enabled_{false};
+	mutable std::mutex threads_mutex_;
+	std::vector<std::shared_ptr<ThreadLog>> threads_;
+	mutable std::mutex frame_mutex_;
+	std::vector<std::int64_t> frame_;
+	std::size_t frame_head_=0;
+	
+	// guarded by frame_mutex_ along with frame_
+	struct ZoneStat {
+		ZoneStat(float hue);
+		std::vector<double> ms;	// per frame, indexed like frame_ms_
+		double current=0;
+		float hue;
+	};
+	std::unordered_map<const char*, ZoneStat> zone_;
+	std::vector<const char*> zone_order_;
+	std::vector<double> frame_ms_;
+	std::size_t stat_head_=0, num_stat_frames_=0;
+	// events that ended during the last complete frame, for the timeline
+	std::vector<ThreadEvents> last_frame_;
+};
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILER_CONCAT(profiler_scope_, __LINE__)(name)
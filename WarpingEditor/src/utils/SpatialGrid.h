@@ -0,0 +1,82 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include "ofRectangle.h"
+
+// uniform grid over 2d points for range queries
+template<typename Value>
+class SpatialGrid
+{
+public:
+	void setup(float cell_size) {
+		clear();
+		cell_size_ = std::max(cell_size, std::numeric_limits<float>::epsilon());
+	}
+	void clear() { cells_.clear(); }
+	void insert(const glm::vec2 &pos, const Value &value) {
+		cells_[key(cellOf(pos))].emplace_back(pos, value);
+	}
+	// moves the entry of value from old_pos to new_pos. returns false if it is not found at old_pos.
+	bool move(const glm::vec2 &old_pos, const glm::vec2 &new_pos, const Value &value) {
+		auto from = cellOf(old_pos), to = cellOf(new_pos);
+		auto found = cells_.find(key(from));
+		if(found == end(cells_)) {
+			return false;
+		}
+		auto &&entries = found->second;
+		auto entry = std::find_if(begin(entries), end(entries), [&](const std::pair<glm::vec2, Value> &e) { return e.second == value; });
+		if(entry == end(entries)) {
+			return false;
+		}
+		if(from == to) {
+			entry->first = new_pos;
+			return true;
+		}
+		std::swap(*entry, entries.back());
+		entries.pop_back();
+		if(entries.empty()) {
+			cells_.erase(found);
+		}
+		insert(new_pos, value);
+		return true;
+	}
+	// calls func(pos, value) for each point inside the area (inclusive)
+	template<typename Func>
+	void query(const ofRectangle &area, Func func) const {
+		float l = area.getMinX(), r = area.getMaxX(), t = area.getMinY(), b = area.getMaxY();
+		auto callIfInside = [&](const std::pair<glm::vec2, Value> &e) {
+			if(l <= e.first.x && e.first.x <= r && t <= e.first.y && e.first.y <= b) {
+				func(e.first, e.second);
+			}
+		};
+		auto lt = cellOf({l,t}), rb = cellOf({r,b});
+		double num_cells_in_area = double(rb.x-lt.x+1)*double(rb.y-lt.y+1);
+		if(num_cells_in_area > cells_.size()) {
+			for(auto &&c : cells_) {
+				for(auto &&e : c.second) callIfInside(e);
+			}
+			return;
+		}
+		for(int y = lt.y; y <= rb.y; ++y) {
+			for(int x = lt.x; x <= rb.x; ++x) {
+				auto found = cells_.find(key({x,y}));
+				if(found == end(cells_)) continue;
+				for(auto &&e : found->second) callIfInside(e);
+			}
+		}
+	}
+private:
+	float cell_size_=1;
+	std::unordered_map<std::uint64_t, std::vector<std::pair<glm::vec2, Value>>> cells_;
+	glm::ivec2 cellOf(const glm::vec2 &pos) const {
+		return {(int)std::floor(pos.x/cell_size_), (int)std::floor(pos.y/cell_size_)};
+	}
+	static std::uint64_t key(const glm::ivec2 &cell) {
+		return (std::uint64_t)(std::uint32_t)cell.x << 32 | (std::uint32_t)cell.y;
+	}
+};
@@ -0,0 +1,39 @@
+#include "TintedMeshDrawer.h"
+#include "ofGLUtils.h"
+#include <algorithm>
+
+void TintedMeshDrawer::draw(const ofMesh &mesh, const ofFloatColor &tint) const
+{
+	auto num_vertices = mesh.getNumVertices();
+	if(num_vertices == 0) {
+		return;
+	}
+	color_.resize(num_vertices);
+	if(mesh.hasColors() && mesh.usingColors()) {
+		auto &&src = mesh.getColors();
+		for(std::size_t i = 0; i < num_vertices; ++i) {
+			auto &&c = src[i];
+			color_[i].set(c.r*tint.r, c.g*tint.g, c.b*tint.b, c.a*tint.a);
+		}
+	}
+	else {
+		std::fill(begin(color_), end(color_), tint);
+	}
+	vbo_.setVertexData(mesh.getVerticesPointer(), (int)num_vertices, GL_STREAM_DRAW);
+	vbo_.setColorData(color_.data(), (int)num_vertices, GL_STREAM_DRAW);
+	if(mesh.hasTexCoords() && mesh.usingTextures()) {
+		vbo_.setTexCoordData(mesh.getTexCoordsPointer(), (int)mesh.getNumTexCoords(), GL_STREAM_DRAW);
+	}
+	else {
+		vbo_.disableTexCoords();
+	}
+	auto mode = ofGetGLPrimitiveMode(mesh.getMode());
+	if(mesh.hasIndices() && mesh.usingIndices()) {
+		vbo_.setIndexData(mesh.getIndexPointer(), (int)mesh.getNumIndices(), GL_STREAM_DRAW);
+		vbo_.drawElements(mode, (int)mesh.getNumIndices());
+	}
+	else {
+		vbo_.disableIndices();
+		vbo_.draw(mode, 0, (int)num_vertices);
+	}
+}
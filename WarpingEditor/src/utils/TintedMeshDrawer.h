@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ofVbo.h"
+#include "ofMesh.h"
+#include "ofColor.h"
+#include <vector>
+
+// draws a mesh with its vertex colors multiplied by a tint.
+// the other attributes are uploaded from the mesh as they are, so a cached mesh is not copied.
+// the tint goes through the bound shader the same way the vertex colors do; it multiplies the sampled texel, alpha included.
+class TintedMeshDrawer
+{
+public:
+	void draw(const ofMesh &mesh, const ofFloatColor &tint) const;
+private:
+	mutable ofVbo vbo_;
+	mutable std::vector<ofFloatColor> color_;
+};
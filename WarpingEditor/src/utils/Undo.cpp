@@ -1,5 +1,7 @@
 #include "Undo.h"
 #include "ofApp.h"
+#include <set>
+#include <cstring>
 
 namespace {
 uint32_t crc32_table[256];
@@ -25,19 +27,86 @@ uint32_t crc32(uint8_t *buf, std::size_t len) {
 	}
 	return c ^ 0xFFFFFFFF;
 }
-uint32_t crc32(const std::string &str) {
-	return crc32((uint8_t*)str.data(), str.length());
+uint32_t crc32(const std::vector<std::size_t> &hash) {
+	return crc32((uint8_t*)hash.data(), hash.size()*sizeof(std::size_t));
 }
 
+// content-defined chunking with a gear rolling hash.
+// boundaries depend only on nearby bytes, so an edit shifts no more than the blocks around it.
+const std::size_t MIN_BLOCK_SIZE = 256;
+const std::size_t MAX_BLOCK_SIZE = 8*1024;
+const uint64_t BOUNDARY_MASK = (1<<10)-1;	// about 1kB on average
+uint64_t gear_table[256];
+bool gear_table_init = false;
+void make_gear_table() {
+	uint64_t x = 0x9E3779B97F4A7C15ull;
+	for(int i = 0; i < 256; ++i) {
+		// splitmix64
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		gear_table[i] = z ^ (z >> 31);
+	}
+	gear_table_init = true;
+}
+std::size_t findBlockEnd(const uint8_t *buf, std::size_t len) {
+	if(!gear_table_init) {
+		make_gear_table();
+	}
+	if(len <= MIN_BLOCK_SIZE) {
+		return len;
+	}
+	std::size_t end = std::min(len, MAX_BLOCK_SIZE);
+	uint64_t h = 0;
+	for(std::size_t i = 0; i < end; ++i) {
+		h = (h << 1) + gear_table[buf[i]];
+		if(i >= MIN_BLOCK_SIZE && (h & BOUNDARY_MASK) == 0) {
+			return i+1;
+		}
+	}
+	return end;
+}
+
+}
+
+std::size_t UndoBuf::size() const
+{
+	std::size_t ret = 0;
+	for(auto &&b : block) {
+		ret += b->size();
+	}
+	return ret;
+}
+std::string UndoBuf::str() const
+{
+	std::string ret;
+	ret.reserve(size());
+	for(auto &&b : block) {
+		ret.append(*b);
+	}
+	return ret;
 }
+
 uint32_t UndoDescriptor::getUndoStateDescriptor()
 {
-	return crc32(undo_.create());
+	auto generation = MeshData::getLatestGeneration();
+	if(!is_checked_ || generation != checked_generation_) {
+		descriptor_ = crc32(undo_.create().hash);
+		checked_generation_ = generation;
+		is_checked_ = true;
+	}
+	return descriptor_;
 }
 
 void Undo::setup(GuiApp *app)
 {
-	app_ = app;
+	setup([app](ByteWriter &writer) { app->packDataFile(writer); },
+		  [app](ByteReader &reader) { app->unpackDataFile(reader); });
+}
+void Undo::setup(std::function<void(ByteWriter&)> pack, std::function<void(ByteReader&)> unpack)
+{
+	pack_ = pack;
+	unpack_ = unpack;
 }
 void Undo::enableAuto(float check_interval)
 {
@@ -51,9 +120,10 @@ void Undo::disableAuto()
 
 Undo::DataType Undo::create() const
 {
-	std::stringstream stream;
-	app_->packDataFile(stream);
-	cache_ = stream.str();
+	ByteWriter writer;
+	writer.reserve(cache_.size());
+	pack_(writer);
+	cache_ = split(writer.data(), writer.size());
 	return cache_;
 }
 Undo::DataType Undo::createUndo() const
@@ -62,16 +132,72 @@ Undo::DataType Undo::createUndo() const
 }
 void Undo::loadUndo(const DataType &data)
 {
-	std::stringstream stream(data);
-	app_->unpackDataFile(stream);
+	auto str = data.str();
+	ByteReader reader(str.data(), str.size());
+	unpack_(reader);
 	cache_ = data;
 }
 
+UndoBuf Undo::split(const char *data, std::size_t size) const
+{
+	UndoBuf ret;
+	const uint8_t *buf = (const uint8_t*)data;
+	// blocks equal to the one at the same offset in the previous snapshot are taken over without hashing
+	const UndoBuf &prev = cache_;
+	std::size_t prev_index = 0, prev_pos = 0;
+	std::size_t pos = 0;
+	while(pos < size) {
+		std::size_t len = findBlockEnd(buf+pos, size-pos);
+		while(prev_index < prev.block.size() && prev_pos < pos) {
+			prev_pos += prev.block[prev_index++]->size();
+		}
+		if(prev_index < prev.block.size() && prev_pos == pos
+		   && prev.block[prev_index]->size() == len
+		   && memcmp(prev.block[prev_index]->data(), buf+pos, len) == 0) {
+			ret.block.push_back(prev.block[prev_index]);
+			ret.hash.push_back(prev.hash[prev_index]);
+		}
+		else {
+			std::string block(data+pos, len);
+			std::size_t hash = std::hash<std::string>()(block);
+			ret.block.push_back(findOrCreateBlock(std::move(block), hash));
+			ret.hash.push_back(hash);
+		}
+		pos += len;
+	}
+	if(block_pool_.size() > block_pool_prune_size_) {
+		for(auto it = begin(block_pool_); it != end(block_pool_);) {
+			it = it->second.expired() ? block_pool_.erase(it) : std::next(it);
+		}
+		block_pool_prune_size_ = std::max<std::size_t>(1024, block_pool_.size()*2);
+	}
+	return ret;
+}
+
+std::shared_ptr<const std::string> Undo::findOrCreateBlock(std::string &&block, std::size_t hash) const
+{
+	auto range = block_pool_.equal_range(hash);
+	for(auto it = range.first; it != range.second; ++it) {
+		auto found = it->second.lock();
+		if(found && *found == block) {
+			return found;
+		}
+	}
+	auto ret = std::make_shared<const std::string>(std::move(block));
+	block_pool_.insert({hash, ret});
+	return ret;
+}
+
 std::size_t Undo::getDataSize() const
 {
+	std::set<const std::string*> counted;
 	std::size_t ret = 0;
 	for(auto &&h : history_) {
-		ret += h.size();
+		for(auto &&b : h.block) {
+			if(counted.insert(b.get()).second) {
+				ret += b->size();
+			}
+		}
 	}
 	return ret;
 }
@@ -2,24 +2,42 @@
 
 #include "ofxUndoState.h"
 #include <memory>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include "ByteBuffer.h"
 
 class GuiApp;
 
-using UndoBuf = std::string;
+// a serialized project split into content-defined blocks.
+// identical blocks are shared between snapshots, so the history only grows by what has changed.
+struct UndoBuf
+{
+	std::vector<std::shared_ptr<const std::string>> block;
+	std::vector<std::size_t> hash;
+	std::size_t size() const;
+	std::string str() const;
+};
 class Undo;
 class UndoDescriptor
 {
 public:
 	UndoDescriptor(Undo &undo):undo_(undo){}
+	// re-serializes only when any mesh, container or blend parameter has been modified since the last check
 	uint32_t getUndoStateDescriptor();
 private:
 	Undo &undo_;
+	bool is_checked_=false;
+	std::size_t checked_generation_=0;
+	uint32_t descriptor_=0;
 };
 class Undo : public ofxUndoState<UndoBuf>
 {
 public:
 	Undo():descriptor_(*this){}
 	void setup(GuiApp *app);
+	void setup(std::function<void(ByteWriter&)> pack, std::function<void(ByteReader&)> unpack);
 	void enableAuto(float check_interval);
 	void disableAuto();
 	
@@ -27,9 +45,16 @@ public:
 	DataType createUndo() const override;
 	void loadUndo(const DataType &data) override;
 	
+	// bytes actually held by the history, counting shared blocks once
 	std::size_t getDataSize() const;
 private:
-	GuiApp *app_;
+	std::function<void(ByteWriter&)> pack_;
+	std::function<void(ByteReader&)> unpack_;
 	mutable UndoBuf cache_;
 	mutable UndoDescriptor descriptor_;
+	
+	mutable std::unordered_multimap<std::size_t, std::weak_ptr<const std::string>> block_pool_;
+	mutable std::size_t block_pool_prune_size_=1024;
+	UndoBuf split(const char *data, std::size_t size) const;
+	std::shared_ptr<const std::string> findOrCreateBlock(std::string &&block, std::size_t hash) const;
 };
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstring>
+#include <algorithm>
+#include "ofMesh.h"
+#include "ofFileUtils.h"
+#include "ofUtils.h"
+#include "ofLog.h"
+#include "MappedFile.h"
+
+// compact binary mesh format to be mapped and used directly without parsing.
+// all fields are little-endian. each array begins at a 16-byte aligned offset.
+namespace binary_mesh {
+enum {
+	HAS_TEXCOORDS = 1<<0,
+	HAS_COLORS = 1<<1,
+};
+struct Header {
+	char magic[4];
+	std::uint32_t version;
+	std::uint32_t mode;
+	std::uint32_t flags;
+	std::uint64_t num_vertices;
+	std::uint64_t num_indices;
+	std::uint64_t vertices_offset;	// float x,y,z
+	std::uint64_t texcoords_offset;	// float u,v
+	std::uint64_t colors_offset;	// float r,g,b,a
+	std::uint64_t indices_offset;	// uint32
+};
+static_assert(sizeof(Header) == 64, "unexpected padding in binary_mesh::Header");
+static_assert(sizeof(glm::vec3) == sizeof(float)*3 && sizeof(glm::vec2) == sizeof(float)*2 && sizeof(ofFloatColor) == sizeof(float)*4, "unexpected vertex attribute layout");
+static const char MAGIC[4] = {'b','m','s','h'};
+static const std::uint32_t VERSION = 1;
+static const std::uint64_t ALIGNMENT = 16;
+static const char EXTENSION[] = "bmsh";
+
+static inline std::uint64_t align(std::uint64_t offset) {
+	return (offset + ALIGNMENT-1) / ALIGNMENT * ALIGNMENT;
+}
+static inline bool isBinaryMeshPath(const std::filesystem::path &filepath) {
+	return ofToLower(ofFilePath::getFileExt(filepath)) == EXTENSION;
+}
+
+static inline Header makeHeader(std::uint64_t num_vertices, std::uint64_t num_indices, std::uint32_t flags, std::uint32_t mode=OF_PRIMITIVE_TRIANGLES) {
+	Header h;
+	std::memcpy(h.magic, MAGIC, 4);
+	h.version = VERSION;
+	h.mode = mode;
+	h.flags = flags;
+	h.num_vertices = num_vertices;
+	h.num_indices = num_indices;
+	std::uint64_t offset = align(sizeof(Header));
+	h.vertices_offset = offset;
+	offset = align(offset + num_vertices*sizeof(glm::vec3));
+	h.texcoords_offset = (flags & HAS_TEXCOORDS) ? offset : 0;
+	if(flags & HAS_TEXCOORDS) offset = align(offset + num_vertices*sizeof(glm::vec2));
+	h.colors_offset = (flags & HAS_COLORS) ? offset : 0;
+	if(flags & HAS_COLORS) offset = align(offset + num_vertices*sizeof(ofFloatColor));
+	h.indices_offset = offset;
+	return h;
+}
+
+// keeps the file mapped; the pointers are valid while this object lives
+class MappedMesh
+{
+public:
+	bool load(const std::filesystem::path &filepath) {
+		header_ = nullptr;
+		if(!file_.open(ofToDataPath(filepath, true))) {
+			ofLogError("binary_mesh") << "failed to map file: " << filepath;
+			return false;
+		}
+		if(file_.size() < sizeof(Header)) {
+			ofLogError("binary_mesh") << "file too small: " << filepath;
+			return false;
+		}
+		auto header = reinterpret_cast<const Header*>(file_.data());
+		if(std::memcmp(header->magic, MAGIC, 4) != 0 || header->version != VERSION) {
+			ofLogError("binary_mesh") << "not a binary mesh or unsupported version: " << filepath;
+			return false;
+		}
+		// compared without adding or multiplying the header values, which could overflow
+		std::uint64_t file_size = file_.size();
+		auto fits = [file_size](std::uint64_t offset, std::uint64_t count, std::uint64_t stride) {
+			return offset % ALIGNMENT == 0 && offset <= file_size && count <= (file_size - offset) / stride;
+		};
+		if(!fits(header->vertices_offset, header->num_vertices, sizeof(glm::vec3))
+		   || ((header->flags & HAS_TEXCOORDS) && !fits(header->texcoords_offset, header->num_vertices, sizeof(glm::vec2)))
+		   || ((header->flags & HAS_COLORS) && !fits(header->colors_offset, header->num_vertices, sizeof(ofFloatColor)))
+		   || !fits(header->indices_offset, header->num_indices, sizeof(std::uint32_t))) {
+			ofLogError("binary_mesh") << "broken file: " << filepath;
+			return false;
+		}
+		// the indices are handed to the renderer as they are, so every one of them has to refer to a vertex
+		auto indices = reinterpret_cast<const std::uint32_t*>(file_.data() + header->indices_offset);
+		auto max_index = std::max_element(indices, indices + header->num_indices);
+		if(max_index != indices + header->num_indices && *max_index >= header->num_vertices) {
+			ofLogError("binary_mesh") << "index out of range: " << *max_index << " >= " << header->num_vertices << " in " << filepath;
+			return false;
+		}
+		header_ = header;
+		return true;
+	}
+	bool isLoaded() const { return header_ != nullptr; }
+	ofPrimitiveMode getMode() const { return static_cast<ofPrimitiveMode>(header_->mode); }
+	std::size_t getNumVertices() const { return header_->num_vertices; }
+	std::size_t getNumIndices() const { return header_->num_indices; }
+	bool hasTexCoords() const { return header_->flags & HAS_TEXCOORDS; }
+	bool hasColors() const { return header_->flags & HAS_COLORS; }
+	const glm::vec3* getVertices() const { return at<glm::vec3>(header_->vertices_offset); }
+	const glm::vec2* getTexCoords() const { return hasTexCoords() ? at<glm::vec2>(header_->texcoords_offset) : nullptr; }
+	const ofFloatColor* getColors() const { return hasColors() ? at<ofFloatColor>(header_->colors_offset) : nullptr; }
+	const std::uint32_t* getIndices() const { return at<std::uint32_t>(header_->indices_offset); }
+
+	ofMesh toMesh() const {
+		ofMesh ret;
+		ret.setMode(getMode());
+		ret.addVertices(getVertices(), getNumVertices());
+		if(hasTexCoords()) ret.addTexCoords(getTexCoords(), getNumVertices());
+		if(hasColors()) ret.addColors(getColors(), getNumVertices());
+		auto *indices = getIndices();
+		ret.getIndices().assign(indices, indices+getNumIndices());
+		return ret;
+	}
+private:
+	MappedFile file_;
+	const Header *header_=nullptr;
+	template<typename T> const T* at(std::uint64_t offset) const {
+		return reinterpret_cast<const T*>(file_.data() + offset);
+	}
+};
+
+static inline bool load(const std::filesystem::path &filepath, ofMesh &dst) {
+	MappedMesh mesh;
+	if(!mesh.load(filepath)) {
+		return false;
+	}
+	dst = mesh.toMesh();
+	return true;
+}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <filesystem>
+#include <cstddef>
+#include <cstdint>
+#include "ofConstants.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+	MappedFile() {}
+	MappedFile(const std::filesystem::path &filepath) { open(filepath); }
+	~MappedFile() { close(); }
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::filesystem::path &filepath) {
+		close();
+#ifdef TARGET_WIN32
+		file_ = CreateFileW(filepath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if(file_ == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		LARGE_INTEGER size;
+		if(!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+			close();
+			return false;
+		}
+		mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(!mapping_) {
+			close();
+			return false;
+		}
+		data_ = static_cast<const std::uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+		size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+		fd_ = ::open(filepath.c_str(), O_RDONLY);
+		if(fd_ < 0) {
+			return false;
+		}
+		struct stat st;
+		if(fstat(fd_, &st) != 0 || st.st_size == 0) {
+			close();
+			return false;
+		}
+		void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+		if(ptr == MAP_FAILED) {
+			close();
+			return false;
+		}
+		data_ = static_cast<const std::uint8_t*>(ptr);
+		size_ = static_cast<std::size_t>(st.st_size);
+#endif
+		if(!data_) {
+			close();
+			return false;
+		}
+		return true;
+	}
+	void close() {
+#ifdef TARGET_WIN32
+		if(data_) UnmapViewOfFile(data_);
+		if(mapping_) CloseHandle(mapping_);
+		if(file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+		mapping_ = nullptr;
+		file_ = INVALID_HANDLE_VALUE;
+#else
+		if(data_) munmap(const_cast<std::uint8_t*>(data_), size_);
+		if(fd_ >= 0) ::close(fd_);
+		fd_ = -1;
+#endif
+		data_ = nullptr;
+		size_ = 0;
+	}
+	bool isOpen() const { return data_ != nullptr; }
+	const std::uint8_t* data() const { return data_; }
+	std::size_t size() const { return size_; }
+private:
+	const std::uint8_t *data_=nullptr;
+	std::size_t size_=0;
+#ifdef TARGET_WIN32
+	HANDLE file_=INVALID_HANDLE_VALUE;
+	HANDLE mapping_=nullptr;
+#else
+	int fd_=-1;
+#endif
+};